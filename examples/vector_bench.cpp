@@ -0,0 +1,38 @@
+
+
+#include <autobind.hpp>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+pymodule(vector_bench);
+pydocstring("round trips between Python sequences and std::vector, for vector_bench.py");
+
+/// Sum a sequence of floats.
+pyexport double sum_doubles(const std::vector<double> &values)
+{
+	return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+/// Sum a sequence of ints.
+pyexport long long sum_ints(const std::vector<std::int32_t> &values)
+{
+	return std::accumulate(values.begin(), values.end(), 0LL);
+}
+
+/// Return a list of the floats 0, 1, ..., n - 1.
+pyexport std::vector<double> range_doubles(int n)
+{
+	std::vector<double> result(n);
+	std::iota(result.begin(), result.end(), 0.0);
+	return result;
+}
+
+/// Return a list of the ints 0, 1, ..., n - 1.
+pyexport std::vector<std::int32_t> range_ints(int n)
+{
+	std::vector<std::int32_t> result(n);
+	std::iota(result.begin(), result.end(), 0);
+	return result;
+}
+
@@ -0,0 +1,38 @@
+
+# Times list <-> std::vector conversions. Lists of exact ints or floats are
+# unboxed in one pass; the subclass and generator cases below can't be, so they
+# show the cost of converting item by item.
+
+import array
+import timeit
+import vector_bench
+
+N = 100000
+
+class Float(float): pass
+class Int(int): pass
+
+floats = [float(i) for i in range(N)]
+ints = list(range(N))
+float_tuple = tuple(floats)
+float_array = array.array('d', floats)
+subclassed_floats = [Float(x) for x in floats]
+subclassed_ints = [Int(x) for x in ints]
+
+cases = [
+	('sum_doubles(list of float)',    lambda: vector_bench.sum_doubles(floats)),
+	('sum_doubles(tuple of float)',   lambda: vector_bench.sum_doubles(float_tuple)),
+	('sum_doubles(array of double)',  lambda: vector_bench.sum_doubles(float_array)),
+	('sum_doubles(list of Float)',    lambda: vector_bench.sum_doubles(subclassed_floats)),
+	('sum_doubles(generator)',        lambda: vector_bench.sum_doubles(x for x in floats)),
+	('sum_ints(list of int)',         lambda: vector_bench.sum_ints(ints)),
+	('sum_ints(list of Int)',         lambda: vector_bench.sum_ints(subclassed_ints)),
+	('sum_ints(generator)',           lambda: vector_bench.sum_ints(x for x in ints)),
+	('range_doubles()',               lambda: vector_bench.range_doubles(N)),
+	('range_ints()',                  lambda: vector_bench.range_ints(N)),
+	('list(range()) for reference',   lambda: list(range(N))),
+]
+
+for name, fn in cases:
+	best = min(timeit.repeat(fn, number=20, repeat=5)) / 20
+	print('{:32} {:8.1f} ns/item'.format(name, best / N * 1e9))
@@ -9,14 +9,26 @@
 #include <Python.h>
 
 #include <cxxabi.h>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
+#include <new>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 #include <map>
 #include <typeinfo>
+#include <unordered_map>
 
 #include "autobind/optional.hpp"
+#include "autobind/span.hpp"
+#include "autobind/string_ref.hpp"
 
 #define AB_PRIVATE_ANNOTATE(a...)        __attribute__((annotate(a)))
 #define AB_PRIVATE_TU_ANNOTATE(a...)     namespace AB_PRIVATE_ANNOTATE(a) { }
@@ -24,16 +36,28 @@
 #define AB_EXPORT                        AB_PRIVATE_ANNOTATE("pyexport")
 #define AB_MODULE(name)                  AB_PRIVATE_TU_ANNOTATE("py:module:" #name)
 #define AB_DOCSTRING(text)               AB_PRIVATE_TU_ANNOTATE("pydocstring:" text)
+#define AB_CODEGEN(option)               AB_PRIVATE_TU_ANNOTATE("py:codegen:" #option)
 #define AB_GETTER(name)                  AB_PRIVATE_ANNOTATE("pygetter:" #name)
 #define AB_SETTER(name)                  AB_PRIVATE_ANNOTATE("pysetter:" #name)
 #define AB_NOEXPORT                      AB_PRIVATE_ANNOTATE("pynoexport")
+#define AB_FREELIST(size)                AB_PRIVATE_ANNOTATE("pyfreelist:" #size)
+#define AB_VIEW                          AB_PRIVATE_ANNOTATE("pyview")
+#define AB_RETURN(policy)                AB_PRIVATE_ANNOTATE("pyreturn:" #policy)
+#define AB_HOLDER(type)                  AB_PRIVATE_ANNOTATE("pyholder:" #type)
+#define AB_IDENTITY                      AB_PRIVATE_ANNOTATE("pyidentity")
 
 #ifndef AB_NO_KEYWORDS
 	#define pyexport    AB_EXPORT
 	#define pymodule    AB_MODULE
 	#define pydocstring AB_DOCSTRING
+	#define pycodegen   AB_CODEGEN
 	#define pygetter    AB_GETTER
 	#define pysetter    AB_SETTER
+	#define pyfreelist  AB_FREELIST
+	#define pyview      AB_VIEW
+	#define pyreturn    AB_RETURN
+	#define pyholder    AB_HOLDER
+	#define pyidentity  AB_IDENTITY
 #endif
 
 
@@ -52,6 +76,8 @@ inline namespace python {
 		// static T load(PyObject *);
 		// static PyObject *dump(const T &);
  		// static const char *pythonTypeName();
+		// static bool check(PyObject *); (optional)
+		// static bool tryLoad(PyObject *, Optional<LoadResult> &); (optional)
 	#else
 		// prevents compile errors while running autobind about missing specializations that
 		// will be automatically filled in later.
@@ -132,6 +158,128 @@ inline namespace python {
 			template <class T>
 			class HasPythonTypeName: public HasMember<T, CheckHasPythonTypeName> { };
 
+			struct CheckHasCheck
+			{
+				template <class T, bool (*)(PyObject *) = &T::check>
+				struct get { };
+			};
+
+			template <class T>
+			class HasCheck: public HasMember<T, CheckHasCheck> { };
+
+			struct CheckHasTryLoad
+			{
+				template <class T, bool (*)(PyObject *, 
+				                            Optional<decltype(T::load(std::declval<PyObject *>()))> &) 
+				                   = &T::tryLoad>
+				struct get { };
+			};
+
+			template <class T>
+			class HasTryLoad: public HasMember<T, CheckHasTryLoad> { };
+
+			/// The struct module format code for the native type T, for those types that
+			/// have one.
+			template <class T> struct BufferFormat;
+			template <> struct BufferFormat<bool>               { static const char *get() { return "?"; } };
+			template <> struct BufferFormat<char>               { static const char *get() { return "c"; } };
+			template <> struct BufferFormat<signed char>        { static const char *get() { return "b"; } };
+			template <> struct BufferFormat<unsigned char>      { static const char *get() { return "B"; } };
+			template <> struct BufferFormat<short>              { static const char *get() { return "h"; } };
+			template <> struct BufferFormat<unsigned short>     { static const char *get() { return "H"; } };
+			template <> struct BufferFormat<int>                { static const char *get() { return "i"; } };
+			template <> struct BufferFormat<unsigned int>       { static const char *get() { return "I"; } };
+			template <> struct BufferFormat<long>               { static const char *get() { return "l"; } };
+			template <> struct BufferFormat<unsigned long>      { static const char *get() { return "L"; } };
+			template <> struct BufferFormat<long long>          { static const char *get() { return "q"; } };
+			template <> struct BufferFormat<unsigned long long> { static const char *get() { return "Q"; } };
+			template <> struct BufferFormat<float>              { static const char *get() { return "f"; } };
+			template <> struct BufferFormat<double>             { static const char *get() { return "d"; } };
+
+			/// Whether T has `data()` returning a pointer to values with a BufferFormat, 
+			/// and `size()` giving their number, like std::vector and std::array.
+			template <class T, class Enable=void>
+			struct HasContiguousData: std::false_type { };
+
+			template <class T>
+			struct HasContiguousData<T, typename std::enable_if<
+				std::is_pointer<decltype(std::declval<T &>().data())>::value
+				&& std::is_integral<decltype(std::declval<const T &>().size())>::value
+				&& sizeof(BufferFormat<typename std::remove_cv<
+					typename std::remove_pointer<decltype(std::declval<T &>().data())>::type
+				>::type>::get())
+			>::type>: std::true_type { };
+
+			/// Whether T has contiguous data and also `shape()` and `strides()`, each giving
+			/// a sequence of integers (the strides counting bytes, as in a Py_buffer) with
+			/// one element per dimension.
+			template <class T, class Enable=void>
+			struct HasStridedData: std::false_type { };
+
+			template <class T>
+			struct HasStridedData<T, typename std::enable_if<
+				HasContiguousData<T>::value
+				&& std::is_integral<typename std::decay<decltype(std::declval<const T &>().shape()[0])>::type>::value
+				&& std::is_integral<typename std::decay<decltype(std::declval<const T &>().strides()[0])>::type>::value
+				&& std::is_integral<decltype(std::declval<const T &>().shape().size())>::value
+			>::type>: std::true_type { };
+
+			/// Whether an array laid out with these shape and strides (in bytes) has its
+			/// elements adjacent in C (row-major) or Fortran (column-major) order.
+			inline bool isContiguous(int ndim, const Py_ssize_t *shape, const Py_ssize_t *strides,
+			                         Py_ssize_t itemsize, char order)
+			{
+				for(int k = 0; k < ndim; ++k)
+				{
+					if(shape[k] == 0) return true;
+				}
+
+				Py_ssize_t expected = itemsize;
+				for(int k = 0; k < ndim; ++k)
+				{
+					int i = order == 'C'? ndim - 1 - k : k;
+					if(shape[i] != 1 && strides[i] != expected) return false;
+					expected *= shape[i];
+				}
+
+				return true;
+			}
+
+			/// Whether a buffer consumer requesting `flags` can handle an array with this
+			/// layout. Consumers that don't ask for strides assume C order.
+			inline bool layoutSatisfies(int flags, int ndim, const Py_ssize_t *shape, 
+			                            const Py_ssize_t *strides, Py_ssize_t itemsize)
+			{
+				bool c = isContiguous(ndim, shape, strides, itemsize, 'C');
+
+				if((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS)
+					return c;
+				if((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS)
+					return isContiguous(ndim, shape, strides, itemsize, 'F');
+				if((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS)
+					return c || isContiguous(ndim, shape, strides, itemsize, 'F');
+				if((flags & PyBUF_STRIDES) != PyBUF_STRIDES)
+					return c;
+
+				return true;
+			}
+
+			/// The `typestr` of the array interface for native values of type T.
+			template <class T>
+			std::string arrayTypestr()
+			{
+				const unsigned short one = 1;
+				const bool littleEndian = *reinterpret_cast<const unsigned char *>(&one);
+
+				char order = sizeof(T) == 1? '|' : littleEndian? '<' : '>';
+				char kind = std::is_same<T, bool>::value?     'b'
+				          : std::is_same<T, char>::value?     'S'
+				          : std::is_floating_point<T>::value? 'f'
+				          : std::is_signed<T>::value?         'i'
+				          :                                   'u';
+				return std::string{order, kind} + std::to_string(sizeof(T));
+			}
+
 			template <class T, class Enable=void>
 			class PythonTypeName
 			{
@@ -183,22 +331,159 @@ inline namespace python {
 		};
 
 
+		/// The buffer exported by classes without a Buffer<T> specialization that have
+		/// contiguous storage (see detail::HasContiguousData): a one-dimensional array
+		/// of their `data()`, read-only if that points to const. The memory is used in
+		/// place, so the object mustn't reallocate it while a buffer is held.
+		template <class T>
+		struct ContiguousBuffer
+		{
+			typedef typename std::remove_pointer<decltype(std::declval<T &>().data())>::type Elt;
+			typedef typename std::remove_cv<Elt>::type Item;
+
+			static int getBuffer(T &x, Py_buffer *view, int flags)
+			{
+				// shape and strides
+				Py_ssize_t *dims = new (std::nothrow) Py_ssize_t[2] { Py_ssize_t(x.size()), sizeof(Item) };
+				if(!dims)
+				{
+					PyErr_NoMemory();
+					return -1;
+				}
+
+				PyObject *obj = view->obj;
+				if(PyBuffer_FillInfo(view, 0, const_cast<Item *>(x.data()), dims[0] * dims[1],
+				                     std::is_const<Elt>::value, flags) < 0)
+				{
+					delete[] dims;
+					return -1;
+				}
+
+				view->obj = obj;
+				view->itemsize = sizeof(Item);
+				view->format = (flags & PyBUF_FORMAT)? const_cast<char *>(detail::BufferFormat<Item>::get()) : 0;
+				view->shape = (flags & PyBUF_ND)? &dims[0] : 0;
+				view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)? &dims[1] : 0;
+				view->internal = dims;
+				return 0;
+			}
+
+			static void releaseBuffer(T &, Py_buffer *view)
+			{
+				delete[] static_cast<Py_ssize_t *>(view->internal);
+			}
+		};
+
+
+		/// The buffer exported by classes without a Buffer<T> specialization whose
+		/// storage is an N-dimensional strided array (see detail::HasStridedData), such
+		/// as a matrix with padded rows. As with ContiguousBuffer, the memory is used 
+		/// in place.
+		template <class T>
+		struct StridedBuffer
+		{
+			typedef typename std::remove_pointer<decltype(std::declval<T &>().data())>::type Elt;
+			typedef typename std::remove_cv<Elt>::type Item;
+
+			static int getBuffer(T &x, Py_buffer *view, int flags)
+			{
+				const auto &shape = x.shape();
+				const auto &strides = x.strides();
+				const int ndim = int(shape.size());
+
+				if(int(strides.size()) != ndim)
+				{
+					PyErr_SetString(PyExc_BufferError, "shape and strides differ in length");
+					return -1;
+				}
+
+				if(std::is_const<Elt>::value && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+				{
+					PyErr_SetString(PyExc_BufferError, "Object is not writable.");
+					return -1;
+				}
+
+				// shape followed by strides
+				Py_ssize_t *dims = new (std::nothrow) Py_ssize_t[2 * ndim + 1];
+				if(!dims)
+				{
+					PyErr_NoMemory();
+					return -1;
+				}
+
+				Py_ssize_t count = 1;
+				for(int i = 0; i < ndim; ++i)
+				{
+					dims[i] = Py_ssize_t(shape[i]);
+					dims[ndim + i] = Py_ssize_t(strides[i]);
+					count *= dims[i];
+				}
+
+				if(!detail::layoutSatisfies(flags, ndim, dims, dims + ndim, sizeof(Item)))
+				{
+					delete[] dims;
+					PyErr_SetString(PyExc_BufferError, "the array is not contiguous in the requested order");
+					return -1;
+				}
+
+				view->buf = const_cast<Item *>(x.data());
+				view->len = count * sizeof(Item);
+				view->readonly = std::is_const<Elt>::value;
+				view->itemsize = sizeof(Item);
+				view->format = (flags & PyBUF_FORMAT)? const_cast<char *>(detail::BufferFormat<Item>::get()) : 0;
+				view->ndim = ndim;
+				view->shape = (flags & PyBUF_ND)? dims : 0;
+				view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)? dims + ndim : 0;
+				view->suboffsets = 0;
+				view->internal = dims;
+				return 0;
+			}
+
+			static void releaseBuffer(T &, Py_buffer *view)
+			{
+				delete[] static_cast<Py_ssize_t *>(view->internal);
+			}
+		};
+
+
 		#define ENABLE_IF(x...) typename std::enable_if<x >::type
 		#define IS_UNIMPL(x...) std::is_base_of<UnimplTag, x >::value
 		namespace detail
 		{
+			/// Buffer<T> if it's specialized, otherwise the automatic buffer that applies,
+			/// if any.
+			template <class T>
+			struct BufferImpl: std::conditional<!IS_UNIMPL(Buffer<T>), Buffer<T>,
+			                   typename std::conditional<HasStridedData<T>::value, StridedBuffer<T>,
+			                   typename std::conditional<HasContiguousData<T>::value, ContiguousBuffer<T>,
+			                                             Buffer<T>>::type>::type> { };
+
+			/// Whether BufferImpl<T> is one of the buffers autobind implements itself.
+			template <class T>
+			struct HasAutomaticBuffer: std::integral_constant<bool,
+				std::is_same<typename BufferImpl<T>::type, StridedBuffer<T>>::value
+				|| std::is_same<typename BufferImpl<T>::type, ContiguousBuffer<T>>::value
+			> { };
 
 			template <class T, class U, class Enable=void>
 			struct BufferProcs 
 			{
+				typedef typename BufferImpl<T>::type Impl;
+
 				static int getbuffer(U *exporter,
 				                     Py_buffer *view,
 				                     int flags)
 				{
 					view->obj = reinterpret_cast<PyObject*>(exporter);
-					int r =  Buffer<T>::getBuffer(exporter->object,
-					                              view,
-					                              flags);
+					int r = Impl::getBuffer(*exporter->object,
+					                        view,
+					                        flags);
+					if(r < 0)
+					{
+						view->obj = 0;
+						return r;
+					}
+
 					Py_XINCREF(view->obj);
 					return r;
 				}
@@ -206,8 +491,8 @@ inline namespace python {
 				static void releasebuffer(U *exporter,
 				                          Py_buffer *view)
 				{
-					Buffer<T>::releaseBuffer(exporter->object,
-					                         view);
+					Impl::releaseBuffer(*exporter->object,
+					                    view);
 				}
 
 				static PyBufferProcs *get()
@@ -222,7 +507,7 @@ inline namespace python {
 			};
 
 			template <class T, class U>
-			struct BufferProcs<T, U, ENABLE_IF(IS_UNIMPL(Buffer<T>))>
+			struct BufferProcs<T, U, ENABLE_IF(IS_UNIMPL(typename BufferImpl<T>::type))>
 			{
 				static PyBufferProcs *get()
 				{
@@ -230,6 +515,94 @@ inline namespace python {
 				}
 			};
 
+			inline PyObject *ssizeTuple(int n, const Py_ssize_t *values)
+			{
+				PyObject *result = PyTuple_New(n);
+				if(!result) return 0;
+
+				for(int i = 0; i < n; ++i)
+				{
+					PyObject *item = PyLong_FromSsize_t(values[i]);
+					if(!item)
+					{
+						Py_DECREF(result);
+						return 0;
+					}
+
+					PyTuple_SET_ITEM(result, i, item);
+				}
+
+				return result;
+			}
+
+			/// Build an `__array_interface__` dictionary describing a buffer.
+			inline PyObject *arrayInterface(const Py_buffer &view, const std::string &typestr)
+			{
+				Py_ssize_t length = view.len / view.itemsize;
+				PyObject *shape = ssizeTuple(view.ndim, view.shape? view.shape : &length);
+				PyObject *strides = ssizeTuple(view.ndim, view.strides? view.strides : &view.itemsize);
+				PyObject *data = Py_BuildValue("(NO)", PyLong_FromVoidPtr(view.buf), 
+				                               view.readonly? Py_True : Py_False);
+
+				PyObject *result = 0;
+				if(shape && strides && data)
+				{
+					result = Py_BuildValue("{s:O,s:s,s:O,s:O,s:i}", 
+					                       "shape", shape, 
+					                       "typestr", typestr.c_str(),
+					                       "data", data,
+					                       "strides", strides,
+					                       "version", 3);
+				}
+
+				Py_XDECREF(shape);
+				Py_XDECREF(strides);
+				Py_XDECREF(data);
+				return result;
+			}
+
+			/// The `__array_interface__` property of classes with an automatic buffer,
+			/// which lets array libraries use their memory without going through a
+			/// memoryview. For other classes getset() gives the end of a getset table.
+			template <class T, class U, class Enable=void>
+			struct ArrayInterface
+			{
+				static PyGetSetDef getset()
+				{
+					return PyGetSetDef();
+				}
+			};
+
+			template <class T, class U>
+			struct ArrayInterface<T, U, ENABLE_IF(HasAutomaticBuffer<T>::value)>
+			{
+				typedef typename BufferImpl<T>::type Impl;
+
+				static PyObject *get(U *self, void *)
+				{
+					Py_buffer view;
+					view.obj = reinterpret_cast<PyObject *>(self);
+					if(Impl::getBuffer(*self->object, &view, PyBUF_RECORDS_RO) < 0) return 0;
+
+					PyObject *result = arrayInterface(view, arrayTypestr<typename Impl::Item>());
+					Impl::releaseBuffer(*self->object, &view);
+					return result;
+				}
+
+				static PyGetSetDef getset()
+				{
+					PyGetSetDef result = {
+						const_cast<char *>("__array_interface__"), 
+						(getter) &get, 
+						0, 
+						const_cast<char *>("The layout of the object's data, for array libraries."), 
+						0
+					};
+
+					return result;
+				}
+			};
+
 
 
 			template <class T, class U, class Enable=void>
@@ -247,7 +620,7 @@ inline namespace python {
 			{
 				static PyObject *converter(U *self)
 				{
-					auto result = Str<T>::convert(self->object);
+					auto result = Str<T>::convert(*self->object);
 					return Conversion<decltype(result)>::dump(result);
 				}
 
@@ -269,7 +642,7 @@ inline namespace python {
 			{
 				static PyObject *converter(U *self)
 				{
-					auto result = Repr<T>::convert(self->object);
+					auto result = Repr<T>::convert(*self->object);
 					return Conversion<decltype(result)>::dump(result);
 				}
 
@@ -311,694 +684,2642 @@ inline namespace python {
 		ObjectRef asObject() const;
 	};
 
-	class IteratorRef
+	namespace detail
 	{
-		std::shared_ptr<PyObject> _iter;
-	public:
-		IteratorRef(PyObject &obj)
-		: _iter(borrow(PyObject_GetIter(&obj)))
+		/// Load a T into `result` without throwing, using `Conversion<T>::tryLoad()` if
+		/// it exists. Returns false if the object cannot be converted; a Python error
+		/// may be set in that case.
+		template <class T>
+		typename std::enable_if<protocols::detail::HasTryLoad<Conversion<T>>::value, bool>::type
+		tryLoad(PyObject *o, Optional<typename ConversionLoadResult<T>::type> &result)
+		{
+			return Conversion<T>::tryLoad(o, result);
+		}
+
+		template <class T>
+		typename std::enable_if<!protocols::detail::HasTryLoad<Conversion<T>>::value, bool>::type
+		tryLoad(PyObject *o, Optional<typename ConversionLoadResult<T>::type> &result)
 		{
-			if(!_iter)
+			try
+			{
+				result.emplace(Conversion<T>::load(o));
+				return true;
+			}
+			catch(Exception &)
+			{
+			}
+			catch(std::runtime_error &)
 			{
-				throw Exception();
 			}
+
+			return false;
 		}
 
-		operator bool() const
+		/// Convert `value` to a new reference, throwing if the conversion fails. A dump()
+		/// may report failure either by throwing or by returning null with an error set.
+		template <class T>
+		PyObject *dumpOrThrow(T &&value)
 		{
-			return _iter != nullptr;
+			typedef typename std::decay<T>::type U;
+			if(PyObject *result = Conversion<U>::dump(std::forward<T>(value)))
+			{
+				return result;
+			}
+
+			throw Exception();
 		}
 
-		std::shared_ptr<PyObject> next()
+		/// Unpack an int into a signed integral type, raising OverflowError if it is out of range.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type
+		unpackExactScalar(PyObject *o, T *out)
 		{
-			if(auto result = PyIter_Next(_iter.get()))
+			long long value;
+			int overflow = 0;
+
+		#if PY_VERSION_HEX >= 0x030C0000
+			// ints of up to 30 bits are read straight from their one digit
+			if(PyUnstable_Long_IsCompact((PyLongObject *) o))
 			{
-				return borrow(result);
+				value = PyUnstable_Long_CompactValue((PyLongObject *) o);
 			}
 			else
+		#endif
 			{
-				_iter = nullptr;
-				return {};
+				// cannot fail otherwise, since `o` is an int
+				value = PyLong_AsLongLongAndOverflow(o, &overflow);
 			}
+
+			if(overflow || value > std::numeric_limits<T>::max() || value < std::numeric_limits<T>::min())
+			{
+				bool negative = overflow? overflow < 0 : value < 0;
+				PyErr_SetString(PyExc_OverflowError,
+				                negative? "signed integer is less than minimum"
+				                        : "signed integer is greater than maximum");
+				return 0;
+			}
+
+			*out = T(value);
+			return 1;
 		}
-	};
 
-	inline IteratorRef iter(PyObject &obj)
-	{
-		return IteratorRef(obj);
-	}
+		/// Unpack an int into an unsigned integral type, raising OverflowError if it is
+		/// negative or out of range.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+		                        && !std::is_same<T, bool>::value, int>::type
+		unpackExactScalar(PyObject *o, T *out)
+		{
+			unsigned long long value;
 
-	class ListRef;
+		#if PY_VERSION_HEX >= 0x030C0000
+			if(PyUnstable_Long_IsCompact((PyLongObject *) o))
+			{
+				Py_ssize_t compact = PyUnstable_Long_CompactValue((PyLongObject *) o);
+				if(compact < 0)
+				{
+					PyErr_SetString(PyExc_OverflowError, "can't convert negative int to unsigned");
+					return 0;
+				}
 
-	class ObjectRef
-	{
-		std::shared_ptr<PyObject> _obj;
-	public:
-		ObjectRef(std::shared_ptr<PyObject> p)
-		: _obj(p) { }
+				value = (unsigned long long) compact;
+			}
+			else
+		#endif
+			{
+				// the maximum is also the error value
+				value = PyLong_AsUnsignedLongLong(o);
+				if(value == (unsigned long long) -1 && PyErr_Occurred()) return 0;
+			}
 
-		ObjectRef()
-		: _obj(getNone()) { } // for STL containers
+			if(value > std::numeric_limits<T>::max())
+			{
+				PyErr_SetString(PyExc_OverflowError, "unsigned integer is greater than maximum");
+				return 0;
+			}
 
-		template <class T>
-		static ObjectRef create(const T &value)
-		{
-			return steal(Conversion<T>::dump(value));
+			*out = T(value);
+			return 1;
 		}
 
-		static ObjectRef steal(PyObject *o)
+		/// Store a double into a floating-point type, raising OverflowError if it is finite
+		/// but out of range.
+		template <class T>
+		int storeFloat(double value, T *out)
 		{
-			return ObjectRef(std::shared_ptr<PyObject>(o, &disposePyObject));
+			if(std::numeric_limits<T>::max() < std::numeric_limits<double>::max()
+			   && std::isfinite(value) && std::fabs(value) > std::numeric_limits<T>::max())
+			{
+				PyErr_SetString(PyExc_OverflowError, "float is out of range");
+				return 0;
+			}
+
+			*out = T(value);
+			return 1;
 		}
 
-		static ObjectRef borrow(PyObject *o)
+		/// Unpack an exact float.
+		template <class T>
+		typename std::enable_if<std::is_floating_point<T>::value, int>::type
+		unpackExactScalar(PyObject *o, T *out)
 		{
-			return ObjectRef(::autobind::borrow(o));
+			return storeFloat(PyFloat_AS_DOUBLE(o), out);
 		}
 
-		static ObjectRef none()
+		/// Unpack True or False.
+		inline int unpackExactScalar(PyObject *o, bool *out)
 		{
-			return ObjectRef(getNone());
+			*out = o == Py_True;
+			return 1;
 		}
 
-		PyObject *release()
+		/// Unpack an exact int as PyArg_Parse's "i" format would.
+		inline int unpackExactInt(PyObject *o, int *out)
 		{
-			// We can't actually release the underlying smart pointer, so just
-			// bump the Python refcount.
-			auto result = _obj.get();
-			Py_XINCREF(result);
-			_obj = getNone();
-			return result;
+			return unpackExactScalar(o, out);
 		}
 
-
-		bool operator <(const ObjectRef &other) const
+		/// Unpack an arbitrary object into an integral type. Like PyArg_Parse's integer
+		/// formats, this accepts objects with __index__, but not floats.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type
+		unpackArgument(PyObject *o, T *out)
 		{
-			int rv = PyObject_RichCompareBool(_obj.get(), other._obj.get(), Py_LT);
-			if(rv < 0)
-			{
-				throw python::Exception();
-			}
-			else
+			if(PyFloat_Check(o))
 			{
-				return rv != 0;
+				PyErr_SetString(PyExc_TypeError, "integer argument expected, got float");
+				return 0;
 			}
+
+			PyObject *index = PyNumber_Index(o);
+			if(!index) return 0;
+
+			int result = unpackExactScalar(index, out);
+			Py_DECREF(index);
+			return result;
 		}
 
-		bool operator ==(const ObjectRef &other) const
+		/// Unpack an arbitrary object into a floating-point type, as PyArg_Parse's "d"
+		/// format would.
+		template <class T>
+		typename std::enable_if<std::is_floating_point<T>::value, int>::type
+		unpackArgument(PyObject *o, T *out)
 		{
-			int rv = PyObject_RichCompareBool(_obj.get(), other._obj.get(), Py_EQ);
-			if(rv < 0)
-			{
-				throw python::Exception();
-			}
-			else
-			{
-				return rv != 0;
-			}
+			double value = PyFloat_AsDouble(o);
+			if(value == -1.0 && PyErr_Occurred()) return 0;
+
+			return storeFloat(value, out);
 		}
 
-		const std::shared_ptr<PyObject> &pyObject() const
+		/// Unpack the truth value of an arbitrary object, as PyArg_Parse's "p" format would.
+		inline int unpackArgument(PyObject *o, bool *out)
 		{
-			return _obj;
+			int value = PyObject_IsTrue(o);
+			if(value < 0) return 0;
+
+			*out = value;
+			return 1;
 		}
 
-		operator PyObject *() const
+		/// Whether `o` is of the Python type that unpackExactScalar() accepts for T.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type
+		isExactScalar(PyObject *o)
 		{
-			return _obj.get();
+			return PyLong_CheckExact(o);
 		}
 
 		template <class T>
-		typename ConversionLoadResult<T>::type convert() const
+		typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+		isExactScalar(PyObject *o)
 		{
-			return Conversion<T>::load(*this);
+			return PyFloat_CheckExact(o);
 		}
 
 		template <class T>
-		Optional<typename ConversionLoadResult<T>::type> tryConverting() const
+		typename std::enable_if<std::is_same<T, bool>::value, bool>::type
+		isExactScalar(PyObject *o)
 		{
-			return this->convert<Optional<T>>();
+			return PyBool_Check(o);
 		}
 
-		std::string repr() const;
-		std::string str() const;
-
-		ListRef asList() const;
-
-
-		ObjectRef getattr(const std::string &name) const
+		/// Unpack any object into a scalar, taking the fast path for its exact Python type.
+		template <class T>
+		int unpackScalar(PyObject *o, T *out)
 		{
-			return getattr(name.c_str());
+			return isExactScalar<T>(o)? unpackExactScalar(o, out) : unpackArgument(o, out);
 		}
-		
 
-		ObjectRef getattr(const char *name) const
+		/// An "O&" converter for PyArg_Parse into the scalar at `out`.
+		template <class T>
+		int convertScalar(PyObject *o, void *out)
 		{
-			if(auto result = PyObject_GetAttrString(*this, name))
-				return steal(result);
-			else
-				throw Exception();
+			return unpackScalar(o, static_cast<T *>(out));
 		}
 
-		void setattr(const std::string &name, ObjectRef o)
+		/// A conservative, non-raising test for whether unpackArgument() could accept `o`.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type
+		mayUnpack(PyObject *o)
 		{
-			setattr(name.c_str(), o);
+			return PyIndex_Check(o);
 		}
 
-		void setattr(const char *name, ObjectRef o)
+		template <class T>
+		typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+		mayUnpack(PyObject *o)
 		{
-			if(PyObject_SetAttrString(*this, name, o) == -1)
-				throw Exception();
+			PyNumberMethods *number = Py_TYPE(o)->tp_as_number;
+			return PyFloat_Check(o) || (number && (number->nb_float || number->nb_index));
 		}
 
-
-		void delattr(const std::string &name)
+		template <class T>
+		typename std::enable_if<std::is_same<T, bool>::value, bool>::type
+		mayUnpack(PyObject *)
 		{
-			delattr(name.c_str());
+			return true;
 		}
 
+		/// Whether unpackHomogeneous() applies to T.
+		template <class T>
+		struct IsBulkScalar: std::integral_constant<bool,
+			std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+		> { };
 
-		void delattr(const char *name)
+		/// Whether a compact int's value is representable in T, tested without branches.
+		template <class T>
+		bool fitsIn(Py_ssize_t value)
 		{
-			if(PyObject_DelAttrString(*this, name) == -1)
-				throw Exception();
+			return std::is_signed<T>::value
+				? (value >= (long long) std::numeric_limits<T>::min()) & (value <= (long long) std::numeric_limits<T>::max())
+				: (value >= 0) & ((unsigned long long) value <= std::numeric_limits<T>::max());
 		}
 
-		template <class... Args>
-		ObjectRef operator ()(const Args &... args)
+		/// Unbox `n` items that are all exact ints into an integral type, as a batch.
+		/// Returns 1 on success, 0 with an OverflowError set if an item is out of range,
+		/// and -1 without an error if not every item is an exact int.
+		template <class T>
+		typename std::enable_if<IsBulkScalar<T>::value && std::is_integral<T>::value, int>::type
+		unpackHomogeneous(PyObject *const *items, Py_ssize_t n, T *out)
 		{
-
-			if(auto result = PyObject_CallFunctionObjArgs(*this, 
-			                                              static_cast<PyObject *>(create(args))...,
-			                                              0))
-			{
-				return steal(result);
-			}
-			else
+			for(Py_ssize_t i = 0; i < n; ++i)
 			{
-				throw python::Exception();
+				if(!PyLong_CheckExact(items[i])) return -1;
 			}
-		}
 
-		operator bool() const
+		#if PY_VERSION_HEX >= 0x030C0000
+			// Compact ints are read without branching on their range, which is checked
+			// once at the end; the rare wider ones take the usual path.
+			bool inRange = true;
+			for(Py_ssize_t i = 0; i < n; ++i)
+			{
+				PyLongObject *item = (PyLongObject *) items[i];
+				if(PyUnstable_Long_IsCompact(item))
+				{
+					Py_ssize_t value = PyUnstable_Long_CompactValue(item);
+					inRange &= fitsIn<T>(value);
+					out[i] = T(value);
+				}
+				else if(!unpackExactScalar(items[i], &out[i]))
+				{
+					return 0;
+				}
+			}
+
+			if(inRange) return 1;
+		#endif
+
+			// find the culprit and raise the right error
+			for(Py_ssize_t i = 0; i < n; ++i)
+			{
+				if(!unpackExactScalar(items[i], &out[i])) return 0;
+			}
+
+			return 1;
+		}
+
+		/// Unbox `n` items that are all exact floats into a floating-point type, as a batch.
+		/// Returns 1 on success, 0 with an OverflowError set if an item is out of range,
+		/// and -1 without an error if not every item is an exact float.
+		template <class T>
+		typename std::enable_if<std::is_floating_point<T>::value, int>::type
+		unpackHomogeneous(PyObject *const *items, Py_ssize_t n, T *out)
 		{
-			int result = PyObject_IsTrue(*this);
-			if(result == -1) throw Exception();
-			return result == 1;
+			for(Py_ssize_t i = 0; i < n; ++i)
+			{
+				if(!PyFloat_CheckExact(items[i])) return -1;
+			}
+
+			bool inRange = true;
+			for(Py_ssize_t i = 0; i < n; ++i)
+			{
+				double value = PyFloat_AS_DOUBLE(items[i]);
+				if(std::numeric_limits<T>::max() < std::numeric_limits<double>::max())
+				{
+					inRange &= !(std::isfinite(value) & (std::fabs(value) > std::numeric_limits<T>::max()));
+				}
+				out[i] = T(value);
+			}
+
+			if(!inRange)
+			{
+				PyErr_SetString(PyExc_OverflowError, "float is out of range");
+				return 0;
+			}
+
+			return 1;
 		}
 
-		bool operator !() const
+		/// Whether a buffer's struct module format and item size describe native values
+		/// of an arithmetic type.
+		template <class T>
+		bool formatMatches(const char *format, Py_ssize_t itemsize)
 		{
-			int result = PyObject_Not(*this);
-			if(result == -1) throw Exception();
-			return result == 1;
+			if(itemsize != sizeof(T)) return false;
+			if(!format) format = "B";
+
+			const unsigned short one = 1;
+			const bool littleEndian = *reinterpret_cast<const unsigned char *>(&one);
+
+			switch(*format)
+			{
+			case '<':
+				if(!littleEndian) return false;
+				++format;
+				break;
+			case '>':
+			case '!':
+				if(littleEndian) return false;
+				++format;
+				break;
+			case '@':
+			case '=':
+				++format;
+				break;
+			}
+
+			if(!format[0] || format[1]) return false;
+
+			const char *kinds = std::is_floating_point<T>::value? "fd"
+			                  : std::is_signed<T>::value?         "bhilqn"
+			                  :                                   "BHILQN";
+			return std::strchr(kinds, format[0]);
 		}
 
-		Py_hash_t hash() const
+		/// Get a C-contiguous buffer of native T values from `obj`. On failure the 
+		/// buffer is not held and no error is set.
+		template <class T>
+		bool getArithmeticBuffer(PyObject *obj, Py_buffer *view, bool writable)
 		{
-			Py_hash_t result = PyObject_Hash(*this);
-			if(result == -1) throw Exception();
-			return result;
+			if(!PyObject_CheckBuffer(obj)) return false;
+
+			int flags = PyBUF_FORMAT | PyBUF_C_CONTIGUOUS | (writable? PyBUF_WRITABLE : 0);
+			if(PyObject_GetBuffer(obj, view, flags) < 0)
+			{
+				// e.g. a read-only or non-contiguous exporter
+				PyErr_Clear();
+				return false;
+			}
+
+			if(!formatMatches<T>(view->format, view->itemsize))
+			{
+				PyBuffer_Release(view);
+				return false;
+			}
+
+			return true;
 		}
 
-		bool isinstance(const ObjectRef &ty) const
+		/// Convert a scalar to a new int, float or bool.
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, PyObject *>::type
+		dumpScalar(T value) noexcept
 		{
-			int result = PyObject_IsInstance(*this, ty);
-			if(result == -1) throw Exception();
-			return result == 1;
+			return sizeof(T) <= sizeof(long)? PyLong_FromLong(long(value)) : PyLong_FromLongLong(value);
 		}
 
-		bool issubclass(const ObjectRef &base) const
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+		                        && !std::is_same<T, bool>::value, PyObject *>::type
+		dumpScalar(T value) noexcept
 		{
-			int result = PyObject_IsSubclass(*this, base);
-			if(result == -1) throw Exception();
-			return result == 1;
+			return sizeof(T) <= sizeof(unsigned long)? PyLong_FromUnsignedLong((unsigned long) value)
+			                                          : PyLong_FromUnsignedLongLong(value);
 		}
 
-		ObjectRef type() const
+		template <class T>
+		typename std::enable_if<std::is_floating_point<T>::value, PyObject *>::type
+		dumpScalar(T value) noexcept
 		{
-			if(auto result = PyObject_Type(*this))
-				return steal(result);
-			else
-				throw Exception();
+			return PyFloat_FromDouble(double(value));
 		}
-	};
 
-	#define MBR(ty, name) inline ty name(const ObjectRef &o) { return o.name(); }
+		inline PyObject *dumpScalar(bool value) noexcept
+		{
+			return PyBool_FromLong(value);
+		}
 
-	MBR(ObjectRef, type)
-	MBR(Py_hash_t, hash)
-	MBR(std::string, str)
-	MBR(std::string, repr)
+	}
 
-	#undef MBR
+	class ListRef;
 
-	inline bool isinstance(const ObjectRef &o, const ObjectRef &ty)
-	{
-		return o.isinstance(ty);
-	}
-	
-	inline bool issubclass(const ObjectRef &derived, const ObjectRef &base)
+	/// A keyword argument of a call made through an ObjectRef; see keyword().
+	template <class T>
+	struct KeywordArgument
 	{
-		return derived.issubclass(base);
-	}
+		const char *name;
+		const T &value;
+	};
 
-	inline ObjectRef getattr(const ObjectRef &o, const char *name)
+	/// Pass `value` as the keyword argument `name`, as in `callback(1, keyword("flag", true))`.
+	/// Keyword arguments must follow the positional ones.
+	template <class T>
+	KeywordArgument<T> keyword(const char *name, const T &value)
 	{
-		return o.getattr(name);
+		return {name, value};
 	}
 
-	inline void setattr(ObjectRef &o, const char *name, const ObjectRef &value)
+	namespace detail
 	{
-		o.setattr(name, value);
-	}
+		template <class T>
+		struct IsKeywordArgument: std::false_type { };
 
-	inline ObjectRef getattr(ObjectRef &o, const char *name, const ObjectRef &defaultValue)
-	{
-		try
-		{
-			return o.getattr(name);
-		}
-		catch(python::Exception &exc)
+		template <class T>
+		struct IsKeywordArgument<KeywordArgument<T> >: std::true_type { };
+
+		template <class... Args>
+		struct KeywordCount: std::integral_constant<size_t, 0> { };
+
+		template <class A, class... Rest>
+		struct KeywordCount<A, Rest...>: std::integral_constant<
+			size_t,
+			IsKeywordArgument<A>::value + KeywordCount<Rest...>::value
+		> { };
+
+		/// Whether no positional argument follows a keyword argument.
+		template <class... Args>
+		struct KeywordsLast: std::true_type { };
+
+		template <class A, class B, class... Rest>
+		struct KeywordsLast<A, B, Rest...>: std::integral_constant<
+			bool,
+			(!IsKeywordArgument<A>::value || IsKeywordArgument<B>::value)
+			&& KeywordsLast<B, Rest...>::value
+		> { };
+
+		template <class T>
+		const char *keywordName(const T &) { return 0; }
+
+		template <class T>
+		const char *keywordName(const KeywordArgument<T> &arg) { return arg.name; }
+
+		/// Build the argument tuple and, if there are keyword arguments, the keyword
+		/// dict for a call made with vectorcall-style arguments. Returns false on failure.
+		inline bool packArguments(PyObject *const *args,
+		                          Py_ssize_t nargs,
+		                          PyObject *kwnames,
+		                          PyObject **tuple,
+		                          PyObject **kwargs)
 		{
-			if(PyErr_ExceptionMatches(PyExc_AttributeError))
+			Py_ssize_t nkw = kwnames? PyTuple_GET_SIZE(kwnames) : 0;
+
+			*kwargs = 0;
+			*tuple = PyTuple_New(nargs);
+			if(!*tuple) return false;
+
+			for(Py_ssize_t i = 0; i < nargs; ++i)
 			{
-				return defaultValue;
+				Py_INCREF(args[i]);
+				PyTuple_SET_ITEM(*tuple, i, args[i]);
 			}
-			else
+
+			if(nkw)
 			{
-				throw;
+				*kwargs = PyDict_New();
+				for(Py_ssize_t k = 0; *kwargs && k < nkw; ++k)
+				{
+					if(PyDict_SetItem(*kwargs, PyTuple_GET_ITEM(kwnames, k), args[nargs + k]) < 0)
+					{
+						Py_CLEAR(*kwargs);
+					}
+				}
+
+				if(!*kwargs)
+				{
+					Py_CLEAR(*tuple);
+					return false;
+				}
 			}
+
+			return true;
 		}
-	}
 
+	#ifdef PY_VECTORCALL_ARGUMENTS_OFFSET
+		constexpr size_t argumentsOffset = PY_VECTORCALL_ARGUMENTS_OFFSET;
+	#else
+		constexpr size_t argumentsOffset = 0;
+	#endif
 
-	inline python::ObjectRef Exception::asObject() const
-	{
-		PyObject *ty=0, *val=0, *tb=0;
-		PyErr_Fetch(&ty, &val, &tb);
-		PyErr_NormalizeException(&ty, &val, &tb);
-		auto result = ObjectRef::borrow(val);
-		PyErr_Restore(ty, val, tb);
-		return result;
+		/// PyObject_Vectorcall, or its equivalent on Pythons without it.
+		inline PyObject *vectorcall(PyObject *callable,
+		                            PyObject *const *args,
+		                            size_t nargsf,
+		                            PyObject *kwnames)
+		{
+		#if PY_VERSION_HEX >= 0x03090000
+			return PyObject_Vectorcall(callable, args, nargsf, kwnames);
+		#elif PY_VERSION_HEX >= 0x03080000
+			return _PyObject_Vectorcall(callable, args, nargsf, kwnames);
+		#else
+			PyObject *tuple, *kwargs;
+			if(!packArguments(args, Py_ssize_t(nargsf), kwnames, &tuple, &kwargs)) return 0;
+
+			PyObject *result = PyObject_Call(callable, tuple, kwargs);
+			Py_DECREF(tuple);
+			Py_XDECREF(kwargs);
+			return result;
+		#endif
+		}
 	}
-	inline const char *Exception::what() const throw()
+
+	/// A strong reference to a Python object, managed with Py_INCREF and Py_DECREF.
+	/// A moved-from or released ObjectRef is empty, and may only be assigned to or
+	/// destroyed.
+	class ObjectRef
 	{
-		if(_msg.empty())
+		PyObject *_obj;
+
+		struct StealTag { };
+
+		ObjectRef(PyObject *o, StealTag)
+		: _obj(o) { }
+	public:
+		/// For compatibility with code written when ObjectRef held a shared_ptr.
+		ObjectRef(const std::shared_ptr<PyObject> &p)
+		: _obj(p.get())
 		{
-			try
-			{
-				auto obj = asObject();
-				_msg = obj.str();
-			}
-			catch(std::exception &exc)
-			{
-				_msg = "<Python exception>";
-			}
+			Py_XINCREF(_obj);
 		}
 
-		return _msg.c_str();
-	}
+		ObjectRef()
+		: _obj(Py_None)
+		{
+			Py_INCREF(_obj); // for STL containers
+		}
 
+		ObjectRef(const ObjectRef &other)
+		: _obj(other._obj)
+		{
+			Py_XINCREF(_obj);
+		}
 
-	class ListRef: public ObjectRef
-	{
-	public:
-		using ObjectRef::ObjectRef;
+		ObjectRef(ObjectRef &&other) noexcept
+		: _obj(other._obj)
+		{
+			other._obj = 0;
+		}
 
-		ListRef(const ObjectRef &other)
-		: ObjectRef(other) { }
+		ObjectRef &operator =(ObjectRef other) noexcept
+		{
+			std::swap(_obj, other._obj);
+			return *this;
+		}
 
-		size_t size() const
+		~ObjectRef()
 		{
-			auto res = PySequence_Size(*this);
-			if(res < 0)
+			Py_XDECREF(_obj);
+		}
+
+		template <class T>
+		static ObjectRef create(const T &value)
+		{
+			return steal(python::detail::dumpOrThrow(value));
+		}
+
+		static ObjectRef steal(PyObject *o)
+		{
+			return ObjectRef(o, StealTag());
+		}
+
+		static ObjectRef borrow(PyObject *o)
+		{
+			Py_XINCREF(o);
+			return ObjectRef(o, StealTag());
+		}
+
+		static ObjectRef none()
+		{
+			return ObjectRef();
+		}
+
+		/// Give up the reference, returning it to the caller and leaving this empty.
+		PyObject *release() noexcept
+		{
+			auto result = _obj;
+			_obj = 0;
+			return result;
+		}
+
+		PyObject *get() const noexcept
+		{
+			return _obj;
+		}
+
+
+		bool operator <(const ObjectRef &other) const
+		{
+			int rv = PyObject_RichCompareBool(_obj, other._obj, Py_LT);
+			if(rv < 0)
 			{
-				throw Exception();
+				throw python::Exception();
+			}
+			else
+			{
+				return rv != 0;
 			}
-
-			return res;
 		}
 
-		template <class T>
-		void set(size_t index, const T &value)
+		bool operator ==(const ObjectRef &other) const
 		{
-			if(PySequence_SetItem(*this, index, Conversion<T>::dump(value)) == -1)
+			int rv = PyObject_RichCompareBool(_obj, other._obj, Py_EQ);
+			if(rv < 0)
 			{
-				throw Exception();
+				throw python::Exception();
 			}
+			else
+			{
+				return rv != 0;
+			}
+		}
+
+		/// For compatibility with code written when ObjectRef held a shared_ptr.
+		std::shared_ptr<PyObject> pyObject() const
+		{
+			return ::autobind::borrow(_obj);
+		}
+
+		operator PyObject *() const
+		{
+			return _obj;
 		}
 
 		template <class T>
-		T get(size_t index) const
+		typename ConversionLoadResult<T>::type convert() const
 		{
-			return Conversion<T>::load(PySequence_GetItem(*this, index));
+			return Conversion<T>::load(*this);
 		}
 
 		template <class T>
-		void append(const T &item)
+		Optional<typename ConversionLoadResult<T>::type> tryConverting() const
 		{
-			if(PyList_Append(*this, Conversion<T>::dump(item)))
-			{
-				throw python::Exception();
-			}
+			return this->convert<Optional<T>>();
 		}
-	};
 
-	inline ListRef ObjectRef::asList() const
-	{
-		return ListRef(*this);
-	}
+		std::string repr() const;
+		std::string str() const;
 
-	template <class T>
-	class Handle
-	{
+		ListRef asList() const;
+
+
+		ObjectRef getattr(const std::string &name) const
+		{
+			return getattr(name.c_str());
+		}
+		
+
+		ObjectRef getattr(const char *name) const
+		{
+			if(auto result = PyObject_GetAttrString(*this, name))
+				return steal(result);
+			else
+				throw Exception();
+		}
+
+		void setattr(const std::string &name, ObjectRef o)
+		{
+			setattr(name.c_str(), o);
+		}
+
+		void setattr(const char *name, ObjectRef o)
+		{
+			if(PyObject_SetAttrString(*this, name, o) == -1)
+				throw Exception();
+		}
+
+
+		void delattr(const std::string &name)
+		{
+			delattr(name.c_str());
+		}
+
+
+		void delattr(const char *name)
+		{
+			if(PyObject_DelAttrString(*this, name) == -1)
+				throw Exception();
+		}
+
+		/// Call the object. Arguments are converted with Conversion, and passed by 
+		/// vectorcall; wrap keyword arguments with keyword().
+		template <class... Args>
+		ObjectRef operator ()(const Args &... args) const
+		{
+			return invoke(0, args...);
+		}
+
+		/// Call the method `name` of the object, without creating a bound method
+		/// where Python allows.
+		template <class... Args>
+		ObjectRef callMethod(const char *name, const Args &... args) const
+		{
+			auto nameRef = steal(PyUnicode_InternFromString(name));
+			if(!nameRef.get()) throw Exception();
+
+			return invoke(nameRef, args...);
+		}
+
+		/// As above, with a name kept from an earlier call, which saves looking it up.
+		template <class... Args>
+		ObjectRef callMethod(const ObjectRef &name, const Args &... args) const
+		{
+			return invoke(name, args...);
+		}
+
+		operator bool() const
+		{
+			int result = PyObject_IsTrue(*this);
+			if(result == -1) throw Exception();
+			return result == 1;
+		}
+
+		bool operator !() const
+		{
+			int result = PyObject_Not(*this);
+			if(result == -1) throw Exception();
+			return result == 1;
+		}
+
+		Py_hash_t hash() const
+		{
+			Py_hash_t result = PyObject_Hash(*this);
+			if(result == -1) throw Exception();
+			return result;
+		}
+
+		bool isinstance(const ObjectRef &ty) const
+		{
+			int result = PyObject_IsInstance(*this, ty);
+			if(result == -1) throw Exception();
+			return result == 1;
+		}
+
+		bool issubclass(const ObjectRef &base) const
+		{
+			int result = PyObject_IsSubclass(*this, base);
+			if(result == -1) throw Exception();
+			return result == 1;
+		}
+
+		ObjectRef type() const
+		{
+			if(auto result = PyObject_Type(*this))
+				return steal(result);
+			else
+				throw Exception();
+		}
+
+	private:
+		template <class T>
+		static ObjectRef argument(const T &value)
+		{
+			return create(value);
+		}
+
+		template <class T>
+		static ObjectRef argument(const KeywordArgument<T> &arg)
+		{
+			return create(arg.value);
+		}
+
+		/// Call the object, or if `name` isn't null, its method `name`.
+		template <class... Args>
+		ObjectRef invoke(PyObject *name, const Args &... args) const
+		{
+			static_assert(python::detail::KeywordsLast<Args...>::value,
+			              "Keyword arguments must follow positional arguments.");
+
+			const size_t nkw = python::detail::KeywordCount<Args...>::value;
+			const size_t nargs = sizeof...(Args) - nkw;
+
+			// the first slot is for `self`, or for the callee to use in passing the 
+			// arguments on
+			ObjectRef owned[] = { steal(nullptr), argument(args)... };
+			PyObject *argv[sizeof...(Args) + 1];
+			argv[0] = _obj;
+			for(size_t i = 1; i <= sizeof...(Args); ++i)
+			{
+				argv[i] = owned[i].get();
+			}
+
+			ObjectRef kwnames = steal(nullptr);
+			if(nkw)
+			{
+				kwnames = steal(PyTuple_New(nkw));
+				if(!kwnames.get()) throw Exception();
+
+				const char *names[] = { nullptr, python::detail::keywordName(args)... };
+				for(size_t k = 0; k < nkw; ++k)
+				{
+					PyObject *kwname = PyUnicode_InternFromString(names[1 + nargs + k]);
+					if(!kwname) throw Exception();
+					PyTuple_SET_ITEM(kwnames.get(), k, kwname);
+				}
+			}
+
+			PyObject *result;
+			if(!name)
+			{
+				result = python::detail::vectorcall(_obj, argv + 1, 
+				                                    nargs | python::detail::argumentsOffset,
+				                                    kwnames);
+			}
+			else
+			{
+			#if PY_VERSION_HEX >= 0x03090000
+				result = PyObject_VectorcallMethod(name, argv, 
+				                                   (nargs + 1) | PY_VECTORCALL_ARGUMENTS_OFFSET,
+				                                   kwnames);
+			#else
+				auto method = steal(PyObject_GetAttr(_obj, name));
+				if(!method.get()) throw Exception();
+
+				result = python::detail::vectorcall(method, argv + 1, 
+				                                    nargs | python::detail::argumentsOffset,
+				                                    kwnames);
+			#endif
+			}
+
+			if(!result) throw Exception();
+			return steal(result);
+		}
+	};
+
+	class IteratorRef
+	{
+		ObjectRef _iter;
+	public:
+		IteratorRef(PyObject &obj)
+		: _iter(ObjectRef::steal(PyObject_GetIter(&obj)))
+		{
+			if(!_iter.get())
+			{
+				throw Exception();
+			}
+		}
+
+		operator bool() const
+		{
+			return _iter.get() != nullptr;
+		}
+
+		/// Store the next item in `item`, or return false if there are no more.
+		bool next(ObjectRef &item)
+		{
+			if(auto result = PyIter_Next(_iter))
+			{
+				item = ObjectRef::steal(result);
+				return true;
+			}
+			else
+			{
+				_iter = ObjectRef::steal(nullptr);
+				return false;
+			}
+		}
+
+		/// The next item, or null if there are no more.
+		std::shared_ptr<PyObject> next()
+		{
+			if(auto result = PyIter_Next(_iter))
+			{
+				return std::shared_ptr<PyObject>(result, disposePyObject);
+			}
+			else
+			{
+				_iter = ObjectRef::steal(nullptr);
+				return {};
+			}
+		}
+	};
+
+	inline IteratorRef iter(PyObject &obj)
+	{
+		return IteratorRef(obj);
+	}
+
+	#define MBR(ty, name) inline ty name(const ObjectRef &o) { return o.name(); }
+
+	MBR(ObjectRef, type)
+	MBR(Py_hash_t, hash)
+	MBR(std::string, str)
+	MBR(std::string, repr)
+
+	#undef MBR
+
+	inline bool isinstance(const ObjectRef &o, const ObjectRef &ty)
+	{
+		return o.isinstance(ty);
+	}
+	
+	inline bool issubclass(const ObjectRef &derived, const ObjectRef &base)
+	{
+		return derived.issubclass(base);
+	}
+
+	inline ObjectRef getattr(const ObjectRef &o, const char *name)
+	{
+		return o.getattr(name);
+	}
+
+	inline void setattr(ObjectRef &o, const char *name, const ObjectRef &value)
+	{
+		o.setattr(name, value);
+	}
+
+	inline ObjectRef getattr(ObjectRef &o, const char *name, const ObjectRef &defaultValue)
+	{
+		try
+		{
+			return o.getattr(name);
+		}
+		catch(python::Exception &exc)
+		{
+			if(PyErr_ExceptionMatches(PyExc_AttributeError))
+			{
+				return defaultValue;
+			}
+			else
+			{
+				throw;
+			}
+		}
+	}
+
+
+	inline python::ObjectRef Exception::asObject() const
+	{
+		PyObject *ty=0, *val=0, *tb=0;
+		PyErr_Fetch(&ty, &val, &tb);
+		PyErr_NormalizeException(&ty, &val, &tb);
+		auto result = ObjectRef::borrow(val);
+		PyErr_Restore(ty, val, tb);
+		return result;
+	}
+	inline const char *Exception::what() const throw()
+	{
+		if(_msg.empty())
+		{
+			try
+			{
+				auto obj = asObject();
+				_msg = obj.str();
+			}
+			catch(std::exception &exc)
+			{
+				_msg = "<Python exception>";
+			}
+		}
+
+		return _msg.c_str();
+	}
+
+
+	class ListRef: public ObjectRef
+	{
+	public:
+		using ObjectRef::ObjectRef;
+
+		ListRef(const ObjectRef &other)
+		: ObjectRef(other) { }
+
+		size_t size() const
+		{
+			auto res = PySequence_Size(*this);
+			if(res < 0)
+			{
+				throw Exception();
+			}
+
+			return res;
+		}
+
+		template <class T>
+		void set(size_t index, const T &value)
+		{
+			auto item = steal(python::detail::dumpOrThrow(value));
+			if(PySequence_SetItem(*this, index, item) == -1)
+			{
+				throw Exception();
+			}
+		}
+
+		template <class T>
+		T get(size_t index) const
+		{
+			return Conversion<T>::load(PySequence_GetItem(*this, index));
+		}
+
+		template <class T>
+		void append(const T &item)
+		{
+			appendNew(python::detail::dumpOrThrow(item));
+		}
+
+		template <class T, class=typename std::enable_if<!std::is_reference<T>::value>::type>
+		void append(T &&item)
+		{
+			appendNew(python::detail::dumpOrThrow(std::move(item)));
+		}
+
+	private:
+		void appendNew(PyObject *item)
+		{
+			auto obj = steal(item);
+			if(PyList_Append(*this, obj))
+			{
+				throw python::Exception();
+			}
+		}
+	};
+
+	inline ListRef ObjectRef::asList() const
+	{
+		return ListRef(*this);
+	}
+
+	template <class T>
+	class Handle
+	{
 		static_assert(!std::is_reference<T>::value,
 		              "Handle<T>: T should not be a reference. Handles always hold references.");
 
-		static_assert(std::is_reference<typename ConversionLoadResult<T>::type>::value,
-		              "Handle<T> may only be used with types for which python::Conversion<T> returns "
-		              "a reference.");
+		static_assert(std::is_reference<typename ConversionLoadResult<T>::type>::value,
+		              "Handle<T> may only be used with types for which python::Conversion<T> returns "
+		              "a reference.");
+
+		ObjectRef _obj; // held to ensure refcount remains > 0
+		T &_ref;
+	public:
+
+		Handle(const ObjectRef &r)
+		: _obj(r)
+		, _ref(Conversion<T>::load(r.get()))
+		{ }
+
+		T &operator *() const
+		{
+			return _ref;
+		}
+
+		T *operator ->() const
+		{
+			return &_ref;
+		}
+
+		T &data() const
+		{
+			return _ref;
+		}
+
+		T &get() const
+		{
+			return _ref;
+		}
+
+		template <class U, class=typename std::enable_if<std::is_same<U, bool>::value>::type>
+		operator U() const
+		{
+			static_assert(!std::is_same<U, U>::value,
+			              "Handles are non-nullable. Delete this null check.");
+		}
+
+		const ObjectRef &asObject() const
+		{
+			return _obj;
+		}
+	};
+	
+	template <class T>
+	struct Conversion<python::Handle<T>>
+	{
+		static python::Handle<T> load(PyObject *obj)
+		{
+			return python::Handle<T>(python::ObjectRef::borrow(obj));
+		}
+	};
+
+
+	template <>
+	struct Conversion<python::ListRef>
+	{
+		static bool tryLoad(PyObject *o, Optional<python::ListRef> &result)
+		{
+			result.emplace(python::ObjectRef::borrow(o));
+			return true;
+		}
+
+		static python::ListRef load(PyObject *o)
+		{
+			return python::ListRef(python::ObjectRef::borrow(o));
+		}
+	};
+
+
+	template <>
+	struct Conversion<python::ObjectRef>
+	{
+		static bool tryLoad(PyObject *o, Optional<python::ObjectRef> &result)
+		{
+			result.emplace(python::ObjectRef::borrow(o));
+			return true;
+		}
+
+		static python::ObjectRef load(PyObject *o)
+		{
+			return python::ObjectRef::borrow(o);
+		}
+
+
+		static PyObject *dump(const python::ObjectRef &oref) noexcept
+		{
+			auto result = oref.get();
+			Py_XINCREF(result);
+			return result;
+		}
+	};
+
+
+	template <>
+	struct Conversion<python::IteratorRef>
+	{
+		static python::IteratorRef load(PyObject *o)
+		{
+			return python::iter(*o);
+		}
+	};
+
+
+	template <>
+	struct Conversion<char>
+	{
+		static bool check(PyObject *o)
+		{
+			return PyUnicode_Check(o);
+		}
+
+		static bool tryLoad(PyObject *o, Optional<char> &result) noexcept
+		{
+			Py_ssize_t n;
+			const char *text;
+			if(!PyUnicode_Check(o) || !(text = PyUnicode_AsUTF8AndSize(o, &n)) || n != 1)
+			{
+				return false;
+			}
+
+			result.emplace(*text);
+			return true;
+		}
+
+		static char load(PyObject *o)
+		{
+			Py_ssize_t n;
+			if(auto text = PyUnicode_AsUTF8AndSize(o, &n))
+			{
+				if(n != 1)
+				{
+					throw std::invalid_argument("String must consist of a single byte.");
+				}
+
+				return *text;
+			}
+			else
+			{
+				throw python::Exception();
+			}
+		}
+		
+		static PyObject *dump(char c) noexcept
+		{
+			return PyUnicode_DecodeUTF8(&c, 1, "surrogateescape");
+		}
+	};
+
+
+	// bool and the arithmetic types other than char. These are spelled out as explicit
+	// specializations, which autobind inspects to tell whether a conversion can throw.
+	#define AB_PRIVATE_SCALAR_CONVERSION(T)                                         \
+	template <>                                                                     \
+	struct Conversion<T>                                                            \
+	{                                                                               \
+		static bool check(PyObject *o) noexcept                                     \
+		{                                                                           \
+			return detail::mayUnpack<T>(o);                                         \
+		}                                                                           \
+		                                                                            \
+		static bool tryLoad(PyObject *o, Optional<T> &result) noexcept              \
+		{                                                                           \
+			T value;                                                                \
+			if(!check(o) || !detail::unpackScalar(o, &value)) return false;         \
+			result.emplace(value);                                                  \
+			return true;                                                            \
+		}                                                                           \
+		                                                                            \
+		static T load(PyObject *o)                                                  \
+		{                                                                           \
+			T value;                                                                \
+			if(!detail::unpackScalar(o, &value)) throw python::Exception();         \
+			return value;                                                           \
+		}                                                                           \
+		                                                                            \
+		static PyObject *dump(T value) noexcept                                     \
+		{                                                                           \
+			return detail::dumpScalar(value);                                       \
+		}                                                                           \
+	};
+
+	AB_PRIVATE_SCALAR_CONVERSION(bool)
+	AB_PRIVATE_SCALAR_CONVERSION(signed char)
+	AB_PRIVATE_SCALAR_CONVERSION(unsigned char)
+	AB_PRIVATE_SCALAR_CONVERSION(short)
+	AB_PRIVATE_SCALAR_CONVERSION(unsigned short)
+	AB_PRIVATE_SCALAR_CONVERSION(int)
+	AB_PRIVATE_SCALAR_CONVERSION(unsigned int)
+	AB_PRIVATE_SCALAR_CONVERSION(long)
+	AB_PRIVATE_SCALAR_CONVERSION(unsigned long)
+	AB_PRIVATE_SCALAR_CONVERSION(long long)
+	AB_PRIVATE_SCALAR_CONVERSION(unsigned long long)
+	AB_PRIVATE_SCALAR_CONVERSION(float)
+	AB_PRIVATE_SCALAR_CONVERSION(double)
+	AB_PRIVATE_SCALAR_CONVERSION(long double)
+
+	#undef AB_PRIVATE_SCALAR_CONVERSION
+
+	template <class T>
+	struct Conversion<std::vector<T> >
+	{
+		static bool check(PyObject *obj)
+		{
+			// the same test PyObject_GetIter() makes
+			return Py_TYPE(obj)->tp_iter || PySequence_Check(obj);
+		}
+
+		static bool tryLoad(PyObject *obj, Optional<std::vector<T>> &result)
+		{
+			if(!check(obj)) return false;
+
+			std::vector<T> items;
+
+			if(loadBuffer(obj, items, detail::IsBulkScalar<T>()))
+			{
+				result.emplace(std::move(items));
+				return true;
+			}
+
+			if(PyList_Check(obj) || PyTuple_Check(obj))
+			{
+				switch(loadHomogeneous(obj, items, detail::IsBulkScalar<T>()))
+				{
+				case 1:
+					result.emplace(std::move(items));
+					return true;
+				case 0:
+					return false;
+				}
+
+				items.reserve(PySequence_Fast_GET_SIZE(obj));
+
+				// Converting an item may run Python code that resizes a list, so its size
+				// is read afresh each time, and the item is kept alive while it's converted.
+				for(Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(obj); ++i)
+				{
+					PyObject *value = PySequence_Fast_GET_ITEM(obj, i);
+					Py_INCREF(value);
+					bool ok = loadItem(items, value);
+					Py_DECREF(value);
+
+					if(!ok) return false;
+				}
+			}
+			else
+			{
+				PyObject *it = PyObject_GetIter(obj);
+				if(!it) return false;
+
+				Py_ssize_t hint = PyObject_LengthHint(obj, 0);
+				if(hint < 0)
+				{
+					Py_DECREF(it);
+					return false;
+				}
+
+				items.reserve(hint);
+
+				while(PyObject *value = PyIter_Next(it))
+				{
+					bool ok = loadItem(items, value);
+					Py_DECREF(value);
+
+					if(!ok)
+					{
+						Py_DECREF(it);
+						return false;
+					}
+				}
+
+				Py_DECREF(it);
+
+				if(PyErr_Occurred())
+				{
+					return false;
+				}
+			}
+
+			result.emplace(std::move(items));
+			return true;
+		}
+
+		static std::vector<T> load(PyObject *obj)
+		{
+			Optional<std::vector<T>> result;
+			if(!tryLoad(obj, result))
+			{
+				if(PyErr_Occurred())
+				{
+					throw python::Exception();
+				}
+
+				throw std::runtime_error("Expected an iterable of convertible items.");
+			}
+
+			return std::move(*result);
+		}
+
+		static PyObject *dump(const std::vector<T> &v)
+		{
+			return dumpItems(v);
+		}
+
+		static PyObject *dump(std::vector<T> &&v)
+		{
+			return dumpItems(std::move(v));
+		}
+
+	private:
+		// A list or tuple of exact ints or floats is type-checked and unboxed in one pass,
+		// which runs no Python code. Returns -1 if the items need converting one by one.
+		static int loadHomogeneous(PyObject *obj, std::vector<T> &items, std::true_type)
+		{
+			Py_ssize_t n = PySequence_Fast_GET_SIZE(obj);
+			items.resize(n);
+
+			int status = detail::unpackHomogeneous(PySequence_Fast_ITEMS(obj), n, items.data());
+			if(status < 0) items.clear();
+			return status;
+		}
+
+		static int loadHomogeneous(PyObject *, std::vector<T> &, std::false_type)
+		{
+			return -1;
+		}
+
+		// Memory with the same layout as the vector's, such as an array.array or a
+		// memoryview of the right format, is copied in bulk.
+		static bool loadBuffer(PyObject *obj, std::vector<T> &items, std::true_type)
+		{
+			Py_buffer view;
+			if(!detail::getArithmeticBuffer<T>(obj, &view, false)) return false;
+
+			items.resize(view.len / sizeof(T));
+			if(view.len) std::memcpy(items.data(), view.buf, view.len);
+			PyBuffer_Release(&view);
+			return true;
+		}
+
+		static bool loadBuffer(PyObject *, std::vector<T> &, std::false_type)
+		{
+			return false;
+		}
+
+		static bool loadItem(std::vector<T> &items, PyObject *value)
+		{
+			typedef typename ConversionLoadResult<T>::type LoadResult;
+
+			Optional<LoadResult> item;
+			if(!python::detail::tryLoad<T>(value, item)) return false;
+
+			items.push_back(std::forward<LoadResult>(*item));
+			return true;
+		}
+
+		// Items are moved from if the vector is an rvalue.
+		template <class Vector>
+		static PyObject *dumpItems(Vector &&v)
+		{
+			typedef typename std::conditional<std::is_lvalue_reference<Vector>::value, 
+			                                  const T &, T &&>::type Item;
+
+			PyObject *list = PyList_New(v.size());
+			if(!list) return 0;
+
+			try
+			{
+				for(size_t i = 0; i < v.size(); ++i)
+				{
+					PyObject *item = Conversion<T>::dump(static_cast<Item>(v[i]));
+					if(!item)
+					{
+						Py_DECREF(list);
+						return 0;
+					}
+
+					PyList_SET_ITEM(list, i, item);
+				}
+			}
+			catch(...)
+			{
+				// the items not yet set are null, which the list ignores
+				Py_DECREF(list);
+				throw;
+			}
+
+			return list;
+		}
+	};
+
+	namespace detail
+	{
+		/// A Span over the memory of a buffer exporter, which holds the buffer until it
+		/// is destroyed.
+		template <class T>
+		class BufferSpan: public Span<T>
+		{
+			Py_buffer _view;
+
+		public:
+			/// Take over a buffer obtained with PyObject_GetBuffer().
+			explicit BufferSpan(Py_buffer &view)
+			: Span<T>(static_cast<T *>(view.buf), view.len / sizeof(T))
+			, _view(view)
+			{
+				view.obj = 0;
+			}
+
+			BufferSpan(BufferSpan &&other)
+			: Span<T>(other)
+			, _view(other._view)
+			{
+				other._view.obj = 0;
+			}
+
+			BufferSpan(const BufferSpan &) = delete;
+			BufferSpan &operator=(const BufferSpan &) = delete;
+
+			~BufferSpan()
+			{
+				if(_view.obj) PyBuffer_Release(&_view);
+			}
+		};
+	}
+
+	/// Span<const T> borrows the memory of any object exporting a C-contiguous buffer
+	/// of T, such as an array.array, bytes or memoryview, without copying it. Span<T>
+	/// additionally requires a writable buffer.
+	template <class T>
+	struct Conversion<Span<T> >
+	{
+		typedef typename std::remove_const<T>::type Item;
+		static_assert(detail::IsBulkScalar<Item>::value,
+		              "Span parameters must have an arithmetic element type other than bool or char.");
+
+		static bool check(PyObject *obj)
+		{
+			return PyObject_CheckBuffer(obj);
+		}
+
+		static bool tryLoad(PyObject *obj, Optional<detail::BufferSpan<T>> &result)
+		{
+			Py_buffer view;
+			if(!detail::getArithmeticBuffer<Item>(obj, &view, !std::is_const<T>::value)) return false;
+
+			// memory that isn't aligned for T can't be borrowed as T
+			if(reinterpret_cast<std::uintptr_t>(view.buf) % alignof(Item))
+			{
+				PyBuffer_Release(&view);
+				return false;
+			}
+
+			result.emplace(view);
+			return true;
+		}
+
+		static detail::BufferSpan<T> load(PyObject *obj)
+		{
+			Optional<detail::BufferSpan<T>> result;
+			if(!tryLoad(obj, result))
+			{
+				throw std::runtime_error(std::is_const<T>::value
+					? "Expected a contiguous buffer of matching format."
+					: "Expected a writable contiguous buffer of matching format.");
+			}
+
+			return std::move(*result);
+		}
+
+		static PyObject *dump(const Span<T> &s)
+		{
+			PyObject *list = PyList_New(s.size());
+			if(!list) return 0;
+
+			for(size_t i = 0; i < s.size(); ++i)
+			{
+				PyObject *item = detail::dumpScalar(s[i]);
+				if(!item)
+				{
+					Py_DECREF(list);
+					return 0;
+				}
+
+				PyList_SET_ITEM(list, i, item);
+			}
+
+			return list;
+		}
+	};
+
+	namespace detail
+	{
+		/// A one-dimensional buffer over memory that belongs to another object, which it
+		/// keeps alive. Fields annotated with AB_VIEW are returned as memoryviews of one.
+		/// The memory is used in place, so the owner mustn't reallocate it while a view
+		/// is held: keeping the owner alive doesn't keep `buf` valid.
+		struct FieldBuffer
+		{
+			PyObject_HEAD
+			PyObject *owner;
+			void *buf;
+			Py_ssize_t length, itemsize;
+			const char *format;
+			bool readonly;
+
+			static int getbuffer(FieldBuffer *self, Py_buffer *view, int flags)
+			{
+				if(PyBuffer_FillInfo(view, (PyObject *) self, self->buf, self->length * self->itemsize, 
+				                     self->readonly, flags) < 0)
+				{
+					return -1;
+				}
+
+				view->itemsize = self->itemsize;
+				if(flags & PyBUF_FORMAT) view->format = const_cast<char *>(self->format);
+				if(flags & PyBUF_ND) view->shape = &self->length;
+				if((flags & PyBUF_STRIDES) == PyBUF_STRIDES) view->strides = &self->itemsize;
+				return 0;
+			}
+
+			static void dealloc(FieldBuffer *self)
+			{
+				Py_DECREF(self->owner);
+				PyObject_Free(self);
+			}
+
+			static PyTypeObject *type()
+			{
+				static PyBufferProcs bufferProcs = { (getbufferproc) &getbuffer, 0 };
+				static PyTypeObject type = { PyVarObject_HEAD_INIT(0, 0) };
+				static bool ready = false;
+
+				if(!ready)
+				{
+					type.tp_name = "autobind.FieldBuffer";
+					type.tp_basicsize = sizeof(FieldBuffer);
+					type.tp_dealloc = (destructor) &dealloc;
+					type.tp_as_buffer = &bufferProcs;
+					type.tp_flags = Py_TPFLAGS_DEFAULT;
+
+					if(PyType_Ready(&type) < 0) return 0;
+					ready = true;
+				}
+
+				return &type;
+			}
+		};
+
+		/// A memoryview of `length` values at `data`, which belong to `owner`.
+		template <class T>
+		PyObject *viewOf(PyObject *owner, const T *data, size_t length, bool readonly)
+		{
+			PyTypeObject *ty = FieldBuffer::type();
+			if(!ty) return 0;
+
+			FieldBuffer *buffer = PyObject_New(FieldBuffer, ty);
+			if(!buffer) return 0;
+
+			Py_INCREF(owner);
+			buffer->owner = owner;
+			buffer->buf = const_cast<T *>(data);
+			buffer->length = Py_ssize_t(length);
+			buffer->itemsize = sizeof(T);
+			buffer->format = protocols::detail::BufferFormat<T>::get();
+			buffer->readonly = readonly;
+
+			PyObject *result = PyMemoryView_FromObject((PyObject *) buffer);
+			Py_DECREF(buffer);
+			return result;
+		}
+
+		/// A memoryview of a field of an object, for the field types AB_VIEW accepts.
+		/// The view of a vector captures its `data()`, so only const vectors, which
+		/// can't be resized, are viewed.
+		template <class T, class Alloc>
+		PyObject *fieldView(PyObject *owner, const std::vector<T, Alloc> &field, bool readonly)
+		{
+			return viewOf(owner, field.data(), field.size(), readonly);
+		}
+
+		template <class T, size_t N>
+		PyObject *fieldView(PyObject *owner, const std::array<T, N> &field, bool readonly)
+		{
+			return viewOf(owner, field.data(), N, readonly);
+		}
+
+		template <class T, size_t N>
+		PyObject *fieldView(PyObject *owner, const T (&field)[N], bool readonly)
+		{
+			return viewOf(owner, field, N, readonly);
+		}
+	}
+
+	template <>
+	struct Conversion<std::string>
+	{
+		static bool check(PyObject *obj)
+		{
+			return PyUnicode_Check(obj);
+		}
+
+		static bool tryLoad(PyObject *obj, Optional<std::string> &result)
+		{
+			if(!check(obj)) return false;
+
+			Py_ssize_t size;
+			if(auto res = PyUnicode_AsUTF8AndSize(obj, &size))
+			{
+				result.emplace(res, size_t(size));
+				return true;
+			}
+
+			return false;
+		}
+
+		static std::string load(PyObject *obj)
+		{
+			if(auto res = PyUnicode_AsUTF8(obj))
+			{
+				return res;
+			}
+			else
+			{
+				throw python::Exception();
+			}
+		}
+
+		static PyObject *dump(const std::string &s) noexcept
+		{
+			return PyUnicode_DecodeUTF8(s.c_str(), s.size(), "surrogateescape");
+		}
+	};
+
+	namespace detail
+	{
+		/// A StringRef into the UTF-8 representation cached by a str, or into a bytes
+		/// object, both of which live as long as the argument itself; or into a
+		/// bytearray, whose buffer is held so that it can't be resized until the
+		/// reference is destroyed.
+		class BorrowedString: public StringRef
+		{
+			Py_buffer _view;
+
+		public:
+			BorrowedString(const char *data, size_t size)
+			: StringRef(data, size)
+			, _view()
+			{ }
+
+			/// Take over a buffer obtained with PyObject_GetBuffer().
+			explicit BorrowedString(Py_buffer &view)
+			: StringRef(static_cast<const char *>(view.buf), view.len)
+			, _view(view)
+			{
+				view.obj = 0;
+			}
+
+			BorrowedString(BorrowedString &&other)
+			: StringRef(other)
+			, _view(other._view)
+			{
+				other._view.obj = 0;
+			}
+
+			BorrowedString(const BorrowedString &) = delete;
+			BorrowedString &operator=(const BorrowedString &) = delete;
+
+			~BorrowedString()
+			{
+				if(_view.obj) PyBuffer_Release(&_view);
+			}
+		};
+
+		inline bool borrowString(PyObject *obj, Optional<BorrowedString> &result)
+		{
+			if(PyUnicode_Check(obj))
+			{
+				Py_ssize_t size;
+				const char *data = PyUnicode_AsUTF8AndSize(obj, &size);
+				if(!data) return false;
+
+				result.emplace(data, size_t(size));
+			}
+			else if(PyBytes_Check(obj))
+			{
+				result.emplace(PyBytes_AS_STRING(obj), size_t(PyBytes_GET_SIZE(obj)));
+			}
+			else if(PyByteArray_Check(obj))
+			{
+				Py_buffer view;
+				if(PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) < 0) return false;
+
+				result.emplace(view);
+			}
+			else
+			{
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	/// StringRef borrows the contents of a str, bytes or bytearray without copying them.
+	template <>
+	struct Conversion<StringRef>
+	{
+		static bool check(PyObject *obj)
+		{
+			return PyUnicode_Check(obj) || PyBytes_Check(obj) || PyByteArray_Check(obj);
+		}
+
+		static bool tryLoad(PyObject *obj, Optional<detail::BorrowedString> &result)
+		{
+			return detail::borrowString(obj, result);
+		}
+
+		static detail::BorrowedString load(PyObject *obj)
+		{
+			Optional<detail::BorrowedString> result;
+			if(!tryLoad(obj, result))
+			{
+				if(PyErr_Occurred())
+				{
+					throw python::Exception();
+				}
+
+				throw std::runtime_error("Expected str, bytes or bytearray.");
+			}
+
+			return std::move(*result);
+		}
+
+		static PyObject *dump(StringRef s) noexcept
+		{
+			return PyUnicode_DecodeUTF8(s.data(), s.size(), "surrogateescape");
+		}
+	};
+
+#if __cplusplus >= 201703L
+	template <>
+	struct Conversion<std::string_view>: Conversion<StringRef>
+	{
+		static PyObject *dump(std::string_view s) noexcept
+		{
+			return PyUnicode_DecodeUTF8(s.data(), s.size(), "surrogateescape");
+		}
+	};
+#endif
+
+
+
+	/// Conversions of the holder of a class annotated with AB_HOLDER. The generated
+	/// conversion of the class provides adopt(), which wraps the object of a holder,
+	/// and for std::shared_ptr, share(), which gets one for a wrapped object. 
+	/// An empty holder converts to None, and None to an empty holder. The object of
+	/// a std::shared_ptr<const T> is copied, as Python could modify it through a wrapper.
+	template <class T>
+	struct Conversion<std::shared_ptr<T> >
+	{
+	private:
+		typedef typename std::remove_const<T>::type U;
+
+		static PyObject *wrap(std::shared_ptr<U> &&ptr) noexcept { return Conversion<U>::adopt(std::move(ptr)); }
+		static PyObject *wrap(std::shared_ptr<const U> &&ptr) noexcept { return Conversion<U>::dump(*ptr); }
+	public:
+		static bool check(PyObject *obj) noexcept
+		{
+			return obj == Py_None || Conversion<U>::check(obj);
+		}
+
+		static std::shared_ptr<T> load(PyObject *obj)
+		{
+			if(obj == Py_None) return nullptr;
+			return Conversion<U>::share(obj);
+		}
+
+		static PyObject *dump(std::shared_ptr<T> ptr) noexcept
+		{
+			if(!ptr) Py_RETURN_NONE;
+			return wrap(std::move(ptr));
+		}
+	};
+
+	/// A std::unique_ptr passes the ownership of its object to Python. Python keeps it,
+	/// so these can be returned to Python but not taken from it: take `T &` instead.
+	template <class T>
+	struct Conversion<std::unique_ptr<T> >
+	{
+		static PyObject *dump(std::unique_ptr<T> ptr) noexcept
+		{
+			if(!ptr) Py_RETURN_NONE;
+			return Conversion<T>::adopt(std::move(ptr));
+		}
+	};
+
+	template <class T, class Enable>
+	struct Conversion<Optional<T>, Enable>
+	{
+	private:
+		typedef typename std::remove_reference<T>::type U;
+	public:
+		static Optional<typename ConversionLoadResult<U>::type>
+		load(PyObject *obj)
+		{
+			Optional<typename ConversionLoadResult<U>::type> result;
+			if(!python::detail::tryLoad<U>(obj, result))
+			{
+				PyErr_Clear();
+			}
+
+			return result;
+		}
+
+		template <class U>
+		static PyObject *dump(const Optional<U> &obj)
+		{
+			static_assert(std::is_convertible<U, T>::value,
+			              "Converter not compatible with this type");
+
+			if(!obj)
+			{
+				Py_RETURN_NONE;
+			}
+			else
+			{
+				return Conversion<T>::dump(*obj);
+			}
+		}
+
+		template <class U>
+		static PyObject *dump(Optional<U> &&obj)
+		{
+			static_assert(std::is_convertible<U, T>::value,
+			              "Converter not compatible with this type");
+
+			if(!obj)
+			{
+				Py_RETURN_NONE;
+			}
+			else
+			{
+				return Conversion<T>::dump(std::move(*obj));
+			}
+		}
+	};
+
+	inline std::string ObjectRef::repr() const
+	{
+		return steal(PyObject_Repr(*this)).convert<std::string>();
+	}
+
+
+	inline std::string ObjectRef::str() const
+	{
+		return steal(PyObject_Str(*this)).convert<std::string>();
+	}
+	
+
+	template <class T>
+	Optional<typename ConversionLoadResult<T>::type> 
+	tryConverting(PyObject *obj)
+	{
+		return Conversion<Optional<typename ConversionLoadResult<T>::type>>::load(obj);
+	}
+
+
+	namespace detail
+	{
+
+		inline std::string demangle(const char *name)
+		{
+			int ok;
+
+			char *buff = abi::__cxa_demangle(name, nullptr, nullptr, &ok);
+			if(ok == 0)
+			{
+				std::string result = buff;
+				std::free(buff);
+				return result;
+			}
+			else
+			{
+				return name;
+			}
+		}
+
+		inline std::string elideTemplateArgs(const std::string &str)
+		{
+			std::string result;
+
+			int openBracketCount = 0;
+			for(char c : str)
+			{
+				if(c == '>')
+				{
+					--openBracketCount;
+				}
+
+				if(!openBracketCount)
+				{
+					result.push_back(c);
+				}
+
+				if(c == '<')
+				{
+					openBracketCount++;
+				}
+			}
+
+			return result;
+		}
+
+		inline std::string elidedDemangle(const char *name)
+		{
+			return elideTemplateArgs(demangle(name));
+		}
+
+		inline int tooManyArguments(Py_ssize_t nparams, Py_ssize_t given)
+		{
+			PyErr_Format(PyExc_TypeError, "function takes at most %zd argument%s (%zd given)",
+			             nparams, nparams == 1? "" : "s", given);
+			return 0;
+		}
+
+		inline int invalidKeyword(PyObject *key,
+		                          const char *const *kwlist,
+		                          Py_ssize_t nargs)
+		{
+			for(Py_ssize_t i = 0; i < nargs; ++i)
+			{
+				if(*kwlist[i] && PyUnicode_CompareWithASCIIString(key, kwlist[i]) == 0)
+				{
+					PyErr_Format(PyExc_TypeError,
+					             "argument for function given by name ('%s') and position (%zd)",
+					             kwlist[i], i + 1);
+					return 0;
+				}
+			}
+
+			PyErr_Format(PyExc_TypeError, "'%U' is an invalid keyword argument for this function", key);
+			return 0;
+		}
+
+		inline int checkRequiredArguments(const char *const *kwlist,
+		                                  Py_ssize_t nargs,
+		                                  Py_ssize_t nparams,
+		                                  PyObject *const *slots)
+		{
+			for(Py_ssize_t i = nargs; i < nparams; ++i)
+			{
+				if(!slots[i])
+				{
+					PyErr_Format(PyExc_TypeError, "Required argument '%s' (pos %zd) not found",
+					             kwlist[i], i + 1);
+					return 0;
+				}
+			}
+
+			return 1;
+		}
+
+		/// Match METH_FASTCALL-style arguments against the parameter names in `kwlist`,
+		/// storing borrowed references to the arguments in `slots`, in parameter order.
+		/// Empty names denote positional-only parameters.
+		///
+		/// Returns 1 on success; on failure, sets a TypeError and returns 0.
+		inline int gatherArguments(PyObject *const *args,
+		                           Py_ssize_t nargs,
+		                           PyObject *kwnames,
+		                           const char *const *kwlist,
+		                           Py_ssize_t nparams,
+		                           PyObject **slots)
+		{
+			Py_ssize_t nkw = kwnames? PyTuple_GET_SIZE(kwnames) : 0;
+
+			if(nargs + nkw > nparams)
+			{
+				return tooManyArguments(nparams, nargs + nkw);
+			}
+
+			for(Py_ssize_t i = 0; i < nparams; ++i)
+			{
+				slots[i] = i < nargs? args[i] : 0;
+			}
+
+			for(Py_ssize_t k = 0; k < nkw; ++k)
+			{
+				PyObject *key = PyTuple_GET_ITEM(kwnames, k);
+
+				Py_ssize_t i = nargs;
+				while(i < nparams && (!*kwlist[i] || PyUnicode_CompareWithASCIIString(key, kwlist[i]) != 0))
+				{
+					++i;
+				}
+
+				if(i == nparams)
+				{
+					return invalidKeyword(key, kwlist, nargs);
+				}
+
+				slots[i] = args[nargs + k];
+			}
+
+			return checkRequiredArguments(kwlist, nargs, nparams, slots);
+		}
+
+		/// Determine whether the keyword arguments (either a dictionary or a METH_FASTCALL
+		/// name tuple) all name parameters after the first `nargs`. Never raises.
+		inline bool keywordsMatch(PyObject *keywords,
+		                          Py_ssize_t nargs,
+		                          std::initializer_list<const char *> names)
+		{
+			auto matches = [&](PyObject *key) {
+				if(!PyUnicode_Check(key)) return false;
+
+				for(auto it = names.begin() + std::min<size_t>(nargs, names.size()); it != names.end(); ++it)
+				{
+					if(PyUnicode_CompareWithASCIIString(key, *it) == 0) return true;
+				}
+
+				return false;
+			};
+
+			if(PyTuple_Check(keywords))
+			{
+				for(Py_ssize_t i = 0; i < PyTuple_GET_SIZE(keywords); ++i)
+				{
+					if(!matches(PyTuple_GET_ITEM(keywords, i))) return false;
+				}
+			}
+			else
+			{
+				Py_ssize_t pos = 0;
+				PyObject *key, *value;
+				while(PyDict_Next(keywords, &pos, &key, &value))
+				{
+					if(!matches(key)) return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// Remembers which alternative of an overloaded function to try first for the
+		/// types of its positional arguments. Calls with keyword arguments, or with more
+		/// than `Arity` positional arguments, are never cached.
+		///
+		/// Zero-initialized static instances are ready to use. Only usable with the GIL
+		/// held; in free-threaded builds, it never caches anything.
+		template <size_t Arity, size_t Entries=4>
+		class OverloadCache
+		{
+			struct Entry
+			{
+				int slot; // alternative index + 1, or 0 if empty
+				Py_ssize_t nargs;
+				PyTypeObject *types[Arity? Arity : 1];
+			};
+
+			Entry _entries[Entries];
+			size_t _next;
+
+			static bool cacheable(Py_ssize_t nargs, Py_ssize_t nkw)
+			{
+			#ifdef Py_GIL_DISABLED
+				return false;
+			#else
+				return nkw == 0 && nargs <= Py_ssize_t(Arity);
+			#endif
+			}
+
+		public:
+			/// Return the alternative recorded for these arguments, or -1 if there is none.
+			int lookup(PyObject *const *args, Py_ssize_t nargs, Py_ssize_t nkw) const
+			{
+				if(!cacheable(nargs, nkw)) return -1;
+
+				for(const auto &e : _entries)
+				{
+					if(e.slot && e.nargs == nargs)
+					{
+						Py_ssize_t i = 0;
+						while(i < nargs && e.types[i] == Py_TYPE(args[i])) ++i;
+
+						if(i == nargs) return e.slot - 1;
+					}
+				}
+
+				return -1;
+			}
+
+			/// Record the alternative to try first for arguments of these types, replacing
+			/// the oldest entry. References to the types are held so that their addresses
+			/// cannot be reused by other types while cached.
+			void record(PyObject *const *args, Py_ssize_t nargs, Py_ssize_t nkw, int index)
+			{
+				if(!cacheable(nargs, nkw)) return;
+
+				auto &e = _entries[_next];
+				_next = (_next + 1) % Entries;
+
+				for(Py_ssize_t i = 0; e.slot && i < e.nargs; ++i)
+				{
+					Py_DECREF(e.types[i]);
+				}
+
+				for(Py_ssize_t i = 0; i < nargs; ++i)
+				{
+					e.types[i] = Py_TYPE(args[i]);
+					Py_INCREF(e.types[i]);
+				}
+
+				e.nargs = nargs;
+				e.slot = index + 1;
+			}
+		};
+
+		/// The parameter names of a function, interned once so that keyword arguments
+		/// (whose names are almost always interned by the compiler) can be matched by
+		/// pointer comparison.
+		template <size_t N>
+		class KeywordNames
+		{
+			const char *const *_kwlist;
+			PyObject *_interned[N + 1];
+		public:
+			/// `kwlist` must contain N names and outlive this object. Empty names denote
+			/// positional-only parameters.
+			explicit KeywordNames(const char *const *kwlist)
+			: _kwlist(kwlist)
+			{
+				for(size_t i = 0; i < N; ++i)
+				{
+					_interned[i] = *kwlist[i]? PyUnicode_InternFromString(kwlist[i]) : 0;
+				}
+
+				// a failure to intern only costs us the pointer comparison
+				PyErr_Clear();
+			}
+
+			/// Find the index of the parameter named `key` at or after `start`, or -1.
+			Py_ssize_t find(PyObject *key, Py_ssize_t start) const
+			{
+				for(Py_ssize_t i = start; i < Py_ssize_t(N); ++i)
+				{
+					if(_interned[i] == key) return i;
+				}
+
+				for(Py_ssize_t i = start; i < Py_ssize_t(N); ++i)
+				{
+					if(*_kwlist[i] && PyUnicode_CompareWithASCIIString(key, _kwlist[i]) == 0) return i;
+				}
+
+				return -1;
+			}
+
+			/// Equivalent to gatherArguments(), for METH_FASTCALL arguments.
+			int gather(PyObject *const *args,
+			           Py_ssize_t nargs,
+			           PyObject *kwnames,
+			           PyObject **slots) const
+			{
+				Py_ssize_t nkw = kwnames? PyTuple_GET_SIZE(kwnames) : 0;
+
+				if(nargs + nkw > Py_ssize_t(N))
+				{
+					return tooManyArguments(N, nargs + nkw);
+				}
+
+				for(Py_ssize_t i = 0; i < Py_ssize_t(N); ++i)
+				{
+					slots[i] = i < nargs? args[i] : 0;
+				}
+
+				for(Py_ssize_t k = 0; k < nkw; ++k)
+				{
+					PyObject *key = PyTuple_GET_ITEM(kwnames, k);
+					Py_ssize_t i = find(key, nargs);
+					if(i < 0)
+					{
+						return invalidKeyword(key, _kwlist, nargs);
+					}
+
+					slots[i] = args[nargs + k];
+				}
+
+				return checkRequiredArguments(_kwlist, nargs, N, slots);
+			}
+
+			/// Equivalent to gatherArguments(), for an argument tuple and keyword dictionary.
+			int gather(PyObject *args,
+			           PyObject *kwargs,
+			           PyObject **slots) const
+			{
+				Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+				Py_ssize_t nkw = kwargs? PyDict_Size(kwargs) : 0;
+
+				if(nargs + nkw > Py_ssize_t(N))
+				{
+					return tooManyArguments(N, nargs + nkw);
+				}
+
+				for(Py_ssize_t i = 0; i < Py_ssize_t(N); ++i)
+				{
+					slots[i] = i < nargs? PyTuple_GET_ITEM(args, i) : 0;
+				}
+
+				Py_ssize_t pos = 0;
+				PyObject *key, *value;
+				while(nkw && PyDict_Next(kwargs, &pos, &key, &value))
+				{
+					Py_ssize_t i = find(key, nargs);
+					if(i < 0)
+					{
+						return invalidKeyword(key, _kwlist, nargs);
+					}
 
-		ObjectRef _obj; // held to ensure refcount remains > 0
-		T &_ref;
-	public:
+					slots[i] = value;
+				}
 
-		Handle(const ObjectRef &r)
-		: _obj(r)
-		, _ref(Conversion<T>::load(r.pyObject().get()))
-		{ }
+				return checkRequiredArguments(_kwlist, nargs, N, slots);
+			}
+		};
 
-		T &operator *() const
+		/// Construct a copy of `value` at `address`. If T cannot be copied, raise a
+		/// TypeError instead.
+		template <class T>
+		typename std::enable_if<std::is_copy_constructible<T>::value>::type
+		copyConstruct(void *address, const T &value)
 		{
-			return _ref;
+			new (address) T(value);
 		}
 
-		T *operator ->() const
+		template <class T>
+		typename std::enable_if<!std::is_copy_constructible<T>::value>::type
+		copyConstruct(void *, const T &)
 		{
-			return &_ref;
+			PyErr_Format(PyExc_TypeError, "%s cannot be copied", 
+			             elidedDemangle(typeid(T).name()).c_str());
+			throw Exception();
 		}
 
-		T &data() const
+		/// Construct a T at `address` from `value`, moving from it if T is move
+		/// constructible and copying otherwise.
+		template <class T>
+		typename std::enable_if<std::is_move_constructible<T>::value>::type
+		constructFrom(void *address, T &value)
 		{
-			return _ref;
+			new (address) T(std::move(value));
 		}
 
-		T &get() const
+		template <class T>
+		typename std::enable_if<!std::is_move_constructible<T>::value>::type
+		constructFrom(void *address, T &value)
 		{
-			return _ref;
+			copyConstruct(address, value);
 		}
 
-		template <class U, class=typename std::enable_if<std::is_same<U, bool>::value>::type>
-		operator U() const
-		{
-			static_assert(!std::is_same<U, U>::value,
-			              "Handles are non-nullable. Delete this null check.");
-		}
+		/// Makes objects owned by a new holder of type H (see AB_HOLDER).
+		template <class H>
+		struct Holder;
 
-		const ObjectRef &asObject() const
-		{
-			return _obj;
-		}
-	};
-	
-	template <class T>
-	struct Conversion<python::Handle<T>>
-	{
-		static python::Handle<T> load(PyObject *obj)
+		template <class T>
+		struct Holder<std::shared_ptr<T> >
 		{
-			return python::Handle<T>(python::ObjectRef(python::borrow(obj)));
-		}
-	};
+			template <class... Args>
+			static std::shared_ptr<T> make(Args &&... args)
+			{
+				return std::make_shared<T>(std::forward<Args>(args)...);
+			}
+		};
 
+		template <class T>
+		struct Holder<std::unique_ptr<T> >
+		{
+			template <class... Args>
+			static std::unique_ptr<T> make(Args &&... args)
+			{
+				return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+			}
+		};
 
-	template <>
-	struct Conversion<python::ListRef>
-	{
-		static python::ListRef load(PyObject *o)
+		/// A new holder of type H owning a copy of `value`. If T cannot be copied, as
+		/// abstract classes can't, raise a TypeError instead.
+		template <class H, class T>
+		typename std::enable_if<std::is_copy_constructible<T>::value, H>::type
+		copyHeld(const T &value)
 		{
-			return python::ListRef(python::borrow(o));
+			return Holder<H>::make(value);
 		}
-	};
-
 
-	template <>
-	struct Conversion<python::ObjectRef>
-	{
-		static python::ObjectRef load(PyObject *o)
+		template <class H, class T>
+		typename std::enable_if<!std::is_copy_constructible<T>::value, H>::type
+		copyHeld(const T &)
 		{
-			return python::ObjectRef(python::borrow(o));
+			PyErr_Format(PyExc_TypeError, "%s cannot be copied", 
+			             elidedDemangle(typeid(T).name()).c_str());
+			throw Exception();
 		}
 
-
-		static PyObject *dump(const python::ObjectRef &oref)
+		/// A new holder of type H owning an object moved from `value` if T is move
+		/// constructible, and copied from it otherwise.
+		template <class H, class T>
+		typename std::enable_if<std::is_move_constructible<T>::value, H>::type
+		moveHeld(T &value)
 		{
-			auto result = oref.pyObject().get();
-			Py_XINCREF(result);
-			return result;
+			return Holder<H>::make(std::move(value));
 		}
-	};
 
-
-	template <>
-	struct Conversion<python::IteratorRef>
-	{
-		static python::IteratorRef load(PyObject *o)
+		template <class H, class T>
+		typename std::enable_if<!std::is_move_constructible<T>::value, H>::type
+		moveHeld(T &value)
 		{
-			return python::iter(*o);
+			return copyHeld<H>(value);
 		}
-	};
-
 
-	template <>
-	struct Conversion<char>
-	{
-		static char load(PyObject *o)
-		{
-			Py_ssize_t n;
-			if(auto text = PyUnicode_AsUTF8AndSize(o, &n))
-			{
-				if(n != 1)
-				{
-					throw std::invalid_argument("String must consist of a single byte.");
-				}
+		/// The alignment guaranteed for objects allocated by PyType_GenericAlloc.
+	#if PY_VERSION_HEX >= 0x03080000
+		constexpr size_t objectAlignment = sizeof(void *) > 4? 16 : 8;
+	#else
+		constexpr size_t objectAlignment = 8;
+	#endif
 
-				return *text;
-			}
-			else
-			{
-				throw python::Exception();
-			}
-		}
-		
-		static PyObject *dump(char c)
+		/// The tp_alloc and tp_free of a generated type whose wrapper struct must be
+		/// aligned to `Align` bytes. These are PyType_GenericAlloc and PyObject_Free unless
+		/// that is more than the Python allocator guarantees.
+		template <size_t Align, class Enable=void>
+		struct ObjectAllocator
 		{
-			auto res = PyUnicode_DecodeUTF8(&c, 1, "surrogateescape");
-			if(!res)
+			static PyObject *alloc(PyTypeObject *ty, Py_ssize_t nitems)
 			{
-				throw python::Exception();
+				return PyType_GenericAlloc(ty, nitems);
 			}
 
-			return res;
-		}
-	};
-
-
-	template <>
-	struct Conversion<int>
-	{
-		static int load(PyObject *o)
-		{
-			int res = PyLong_AsLong(o);
-			if(PyErr_Occurred())
+			/// Allocate an object of the generated type `ty` (not of a subclass) with
+			/// only the first `size` bytes of its struct, for objects that never use
+			/// the rest. It is freed by free() like any other.
+			static PyObject *allocate(PyTypeObject *ty, size_t size)
 			{
-				throw python::Exception();
+				void *obj = PyObject_Malloc(size);
+				if(!obj) return PyErr_NoMemory();
+
+				std::memset(obj, 0, size);
+				return PyObject_Init((PyObject *) obj, ty);
 			}
-			return res;
-		}
 
-		static PyObject *dump(int i)
-		{
-			auto res = PyLong_FromLong(i);
-			if(!res)
+			static void free(void *ptr)
 			{
-				throw python::Exception();
+				PyObject_Free(ptr);
 			}
+		};
 
-			return res;
-		}
-	};
-
-	template <class T>
-	struct Conversion<std::vector<T> >
-	{
-		static std::vector<T> load(PyObject *obj)
+		// Over-aligned objects are placed in a larger block, preceded by the
+		// address of the block.
+		template <size_t Align>
+		struct ObjectAllocator<Align, typename std::enable_if<(Align > objectAlignment)>::type>
 		{
-			auto it = python::iter(*obj);
-
-			std::vector<T> result;
-
-			while(auto value = it.next())
+			// generated types are never variable-sized
+			static PyObject *alloc(PyTypeObject *ty, Py_ssize_t)
 			{
-				result.push_back(Conversion<T>::load(value.get()));
+				return allocate(ty, ty->tp_basicsize);
 			}
 
-			return result;
-		}
+			static PyObject *allocate(PyTypeObject *ty, size_t size)
+			{
+				char *block = (char *) PyObject_Malloc(size + Align + sizeof(void *));
+				if(!block) return PyErr_NoMemory();
 
-		static PyObject *dump(const std::vector<T> &v)
-		{
-			auto lst = PyList_New(0);
-			auto lref = Conversion<python::ListRef>::load(lst);
+				auto address = reinterpret_cast<uintptr_t>(block + sizeof(void *));
+				char *obj = block + sizeof(void *) + (Align - address % Align) % Align;
 
+				reinterpret_cast<void **>(obj)[-1] = block;
+				std::memset(obj, 0, size);
+				return PyObject_Init((PyObject *) obj, ty);
+			}
 
-			for(const auto &item : v)
+			static void free(void *ptr)
 			{
-				lref.append(item);
+				PyObject_Free(reinterpret_cast<void **>(ptr)[-1]);
 			}
+		};
 
-			return lst;
-		}
-	};
-
-	template <>
-	struct Conversion<std::string>
-	{
-		static std::string load(PyObject *obj)
-		{
-			if(auto res = PyUnicode_AsUTF8(obj))
+		/// A bounded stack of the memory of deallocated objects of a single type, reused
+		/// by later allocations of that type, like CPython's own float and tuple freelists.
+		/// Only usable with the GIL held; in free-threaded builds, it never keeps anything.
+		template <size_t Capacity>
+		class Freelist
+		{
+			PyObject *_items[Capacity];
+			size_t _size = 0;
+		public:
+			/// Initialize a reused object of type `ty` and return it, or return null if
+			/// there is none. Unlike tp_alloc, this does not clear the object's memory.
+			PyObject *pop(PyTypeObject *ty) noexcept
 			{
-				return res;
+			#ifdef Py_GIL_DISABLED
+				return 0;
+			#else
+				if(!_size) return 0;
+				return PyObject_Init(_items[--_size], ty);
+			#endif
 			}
-			else
+
+			/// Keep the memory of a deallocated object for reuse. Returns false if
+			/// the freelist is full, in which case the caller must free it.
+			bool push(PyObject *o) noexcept
 			{
-				throw python::Exception();
+			#ifdef Py_GIL_DISABLED
+				return false;
+			#else
+				if(_size == Capacity) return false;
+				_items[_size++] = o;
+				return true;
+			#endif
 			}
-		}
+		};
 
-		static PyObject *dump(const std::string &s)
+		/// The deleter of a shared_ptr that keeps a Python object alive, such as one
+		/// from Conversion<std::shared_ptr<T>>::load(). The last copy may be dropped
+		/// on any thread, or after the interpreter has been finalized (which frees the
+		/// object anyway), so this doesn't assume the GIL is held.
+		struct ReleaseWithGIL
 		{
-			auto res = PyUnicode_DecodeUTF8(s.c_str(), s.size(), "surrogateescape");
-			if(!res)
-			{
-				throw python::Exception();
-			}
-			return res;
-		}
-	};
+			PyObject *obj;
 
+			void operator ()(const void *) const noexcept
+			{
+				if(!Py_IsInitialized()) return;
 
+				PyGILState_STATE state = PyGILState_Ensure();
+				Py_DECREF(obj);
+				PyGILState_Release(state);
+			}
+		};
 
-	template <class T, class Enable>
-	struct Conversion<Optional<T>, Enable>
-	{
-	private:
-		typedef typename std::remove_reference<T>::type U;
-	public:
-		static Optional<typename ConversionLoadResult<U>::type>
-		load(PyObject *obj)
-		{
-			try
+		/// The wrappers of the objects of a class annotated with AB_IDENTITY, by the
+		/// addresses of the objects. The references are weak: a wrapper removes itself
+		/// when it is deallocated. Only usable with the GIL held; in free-threaded builds,
+		/// it never finds anything.
+		class Registry
+		{
+			std::unordered_map<const void *, PyObject *> _wrappers;
+		public:
+			/// A new reference to the wrapper of the object at `address`, or null if
+			/// there is none.
+			PyObject *find(const void *address) noexcept
 			{
-				return Conversion<U>::load(obj);
+			#ifdef Py_GIL_DISABLED
+				return 0;
+			#else
+				auto it = _wrappers.find(address);
+				if(it == _wrappers.end()) return 0;
+
+				Py_INCREF(it->second);
+				return it->second;
+			#endif
 			}
-			catch(Exception &)
+
+			/// Record `wrapper` as the wrapper of the object at `address`. If this fails
+			/// for lack of memory, the object will just get another wrapper next time.
+			void add(const void *address, PyObject *wrapper) noexcept
 			{
-				PyErr_Clear();
+			#ifndef Py_GIL_DISABLED
+				try
+				{
+					_wrappers[address] = wrapper;
+				}
+				catch(std::bad_alloc &)
+				{
+				}
+			#endif
 			}
-			catch(std::runtime_error &)
+
+			/// Forget `wrapper`, if it is the recorded wrapper of the object at `address`.
+			void remove(const void *address, PyObject *wrapper) noexcept
 			{
+			#ifndef Py_GIL_DISABLED
+				auto it = _wrappers.find(address);
+				if(it != _wrappers.end() && it->second == wrapper)
+				{
+					_wrappers.erase(it);
+				}
+			#endif
 			}
+		};
 
-			return {};
-		}
-
-		template <class U>
-		static PyObject *dump(const Optional<U> &obj)
+		/// Call `ty` with vectorcall-style arguments the way `type.__call__` would,
+		/// through its tp_new and tp_init. This is the fallback for subclasses that
+		/// inherit the tp_vectorcall of a generated type, whose __init__ may need to run.
+		inline PyObject *callTypeSlots(PyTypeObject *ty,
+		                               PyObject *const *args,
+		                               Py_ssize_t nargs,
+		                               PyObject *kwnames)
 		{
-			static_assert(std::is_convertible<U, T>::value,
-			              "Converter not compatible with this type");
+			PyObject *tuple, *kwargs;
+			if(!packArguments(args, nargs, kwnames, &tuple, &kwargs)) return 0;
 
-			if(!obj)
+			PyObject *result = ty->tp_new(ty, tuple, kwargs);
+			if(result && PyObject_TypeCheck(result, ty) && Py_TYPE(result)->tp_init
+			   && Py_TYPE(result)->tp_init(result, tuple, kwargs) < 0)
 			{
-				Py_RETURN_NONE;
-			}
-			else
-			{
-				return Conversion<T>::dump(*obj);
+				Py_CLEAR(result);
 			}
-		}
-	};
-
-	inline std::string ObjectRef::repr() const
-	{
-		return steal(PyObject_Repr(*this)).convert<std::string>();
-	}
-
-
-	inline std::string ObjectRef::str() const
-	{
-		return steal(PyObject_Str(*this)).convert<std::string>();
-	}
-	
-
-	template <class T>
-	Optional<typename ConversionLoadResult<T>::type> 
-	tryConverting(PyObject *obj)
-	{
-		return Conversion<Optional<typename ConversionLoadResult<T>::type>>::load(obj);
-	}
 
+			Py_DECREF(tuple);
+			Py_XDECREF(kwargs);
+			return result;
+		}
 
-	namespace detail
-	{
-
-		inline std::string demangle(const char *name)
+		/// Unpack a str as PyArg_Parse's "s" format would. The result is borrowed from `o`.
+		inline int unpackExactString(PyObject *o, const char **out)
 		{
-			int ok;
+			Py_ssize_t size;
+			const char *result = PyUnicode_AsUTF8AndSize(o, &size);
 
-			char *buff = abi::__cxa_demangle(name, nullptr, nullptr, &ok);
-			if(ok == 0)
-			{
-				std::string result = buff;
-				std::free(buff);
-				return result;
-			}
-			else
+			if(!result) return 0;
+
+			if(std::strlen(result) != size_t(size))
 			{
-				return name;
+				PyErr_SetString(PyExc_ValueError, "embedded null character");
+				return 0;
 			}
+
+			*out = result;
+			return 1;
 		}
 
-		inline std::string elideTemplateArgs(const std::string &str)
+		/// Unpack an arbitrary object as PyArg_Parse's "s" format would.
+		inline int unpackArgument(PyObject *o, const char **out)
 		{
-			std::string result;
-
-			int openBracketCount = 0;
-			for(char c : str)
+			if(!PyUnicode_Check(o))
 			{
-				if(c == '>')
-				{
-					--openBracketCount;
-				}
-
-				if(!openBracketCount)
-				{
-					result.push_back(c);
-				}
-
-				if(c == '<')
-				{
-					openBracketCount++;
-				}
+				PyErr_Format(PyExc_TypeError, "argument must be str, not %.50s", Py_TYPE(o)->tp_name);
+				return 0;
 			}
 
-			return result;
+			return unpackExactString(o, out);
 		}
 
-		inline std::string elidedDemangle(const char *name)
+		/// A conservative test for whether `Conversion<T>::load()` could accept `o`, used
+		/// to skip overloads cheaply. Types without a `check()` accept everything.
+		template <class T>
+		typename std::enable_if<protocols::detail::HasCheck<Conversion<T>>::value, bool>::type
+		mayLoad(PyObject *o)
 		{
-			return elideTemplateArgs(demangle(name));
+			return Conversion<T>::check(o);
+		}
+
+		template <class T>
+		typename std::enable_if<!protocols::detail::HasCheck<Conversion<T>>::value, bool>::type
+		mayLoad(PyObject *)
+		{
+			return true;
 		}
 
 		template <class T>
@@ -1014,12 +3335,13 @@ inline namespace python {
 			{
 				auto &result = *static_cast<typename ConversionFunc<T>::Value *>(address);
 
-				result.value.reset(tryConverting<T>(pyObject));
-
-				if(!result.value)
+				if(!python::detail::tryLoad<T>(pyObject, result.value))
 				{
-					PyErr_Format(PyExc_TypeError, "%s",
-					             result.errorMessage);
+					// keep errors more specific than a type mismatch, such as overflow
+					if(!PyErr_Occurred())
+					{
+						PyErr_SetString(PyExc_TypeError, result.errorMessage);
+					}
 
 					return 0;
 				}
@@ -125,6 +125,32 @@ public:
 	}
 
 
+	/// Destroy the current value, if any, and construct a new one in place.
+	template <class... Args>
+	T &emplace(Args &&... args)
+	{
+		if(_exists)
+		{
+			_storage.destruct();
+			_exists = false;
+		}
+
+		_storage.construct(std::forward<Args>(args)...);
+		_exists = true;
+		return _storage.get();
+	}
+
+
+	/// Destroy the current value, if any.
+	void reset()
+	{
+		if(_exists)
+		{
+			_storage.destruct();
+			_exists = false;
+		}
+	}
+
 	void reset(const Optional &value)
 	{
 		if(this == &value) return;
@@ -0,0 +1,61 @@
+///
+/// @file span.hpp
+///
+/// A minimal view of a contiguous array, standing in for C++20's std::span.
+/// Parameters of type Span<const T> borrow the memory of a Python object
+/// exporting the buffer protocol for the duration of a call.
+
+#ifndef SPAN_HPP_7QK2VD
+#define SPAN_HPP_7QK2VD
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+namespace autobind {
+
+template <class T>
+class Span
+{
+	T *_data;
+	std::size_t _size;
+
+public:
+	typedef T element_type;
+	typedef typename std::remove_cv<T>::type value_type;
+	typedef T *iterator;
+
+	Span()
+	: _data(nullptr)
+	, _size(0)
+	{ }
+
+	Span(T *data, std::size_t size)
+	: _data(data)
+	, _size(size)
+	{ }
+
+	template <class U, class Alloc,
+	          class = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+	Span(std::vector<U, Alloc> &v)
+	: _data(v.data())
+	, _size(v.size())
+	{ }
+
+	template <class U, class Alloc,
+	          class = typename std::enable_if<std::is_convertible<const U (*)[], T (*)[]>::value>::type>
+	Span(const std::vector<U, Alloc> &v)
+	: _data(v.data())
+	, _size(v.size())
+	{ }
+
+	T *data() const { return _data; }
+	std::size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	T *begin() const { return _data; }
+	T *end() const { return _data + _size; }
+
+	T &operator[](std::size_t i) const { return _data[i]; }
+};
+
+} // autobind
+#endif // SPAN_HPP_7QK2VD
@@ -0,0 +1,91 @@
+///
+/// @file string_ref.hpp
+///
+/// A non-owning reference to a string, standing in for C++17's std::string_view.
+/// Parameters of type StringRef borrow the UTF-8 representation of a str, or the
+/// contents of a bytes or bytearray, for the duration of a call.
+
+#ifndef STRING_REF_HPP_5JX0RW
+#define STRING_REF_HPP_5JX0RW
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+namespace autobind {
+
+class StringRef
+{
+	const char *_data;
+	std::size_t _size;
+
+public:
+	typedef const char *iterator;
+
+	StringRef()
+	: _data("")
+	, _size(0)
+	{ }
+
+	StringRef(const char *data, std::size_t size)
+	: _data(data)
+	, _size(size)
+	{ }
+
+	StringRef(const char *s)
+	: _data(s)
+	, _size(std::strlen(s))
+	{ }
+
+	StringRef(const std::string &s)
+	: _data(s.data())
+	, _size(s.size())
+	{ }
+
+	const char *data() const { return _data; }
+	std::size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	const char *begin() const { return _data; }
+	const char *end() const { return _data + _size; }
+
+	char operator[](std::size_t i) const { return _data[i]; }
+
+	std::string str() const { return std::string(_data, _size); }
+	explicit operator std::string() const { return str(); }
+
+#if __cplusplus >= 201703L
+	StringRef(std::string_view s)
+	: _data(s.data())
+	, _size(s.size())
+	{ }
+
+	operator std::string_view() const { return std::string_view(_data, _size); }
+#endif
+
+	int compare(StringRef other) const
+	{
+		int result = std::memcmp(_data, other._data, std::min(_size, other._size));
+		if(result) return result;
+		return _size < other._size? -1 : _size > other._size? 1 : 0;
+	}
+
+	friend bool operator==(StringRef a, StringRef b)
+	{
+		return a._size == b._size && std::memcmp(a._data, b._data, a._size) == 0;
+	}
+
+	friend bool operator!=(StringRef a, StringRef b) { return !(a == b); }
+	friend bool operator<(StringRef a, StringRef b) { return a.compare(b) < 0; }
+
+	friend std::ostream &operator<<(std::ostream &os, StringRef s)
+	{
+		return os.write(s._data, s._size);
+	}
+};
+
+} // autobind
+#endif // STRING_REF_HPP_5JX0RW
@@ -2,6 +2,13 @@
 #include "stream.hpp"
 #include "printing.hpp"
 #include "StringTemplate.hpp"
+#include "util.hpp"
+#include "attributeStream.hpp"
+#include "diagnostics.hpp"
+
+#include <clang/AST/ASTContext.h>
+
+#include <map>
 
 namespace autobind {
 
@@ -12,6 +19,7 @@ CallGenerator::CallGenerator(std::string argsRef,
 : _unpacker(std::move(argsRef), std::move(kwargsRef))
 , _decl(decl)
 , _prefix(std::move(prefix))
+, _returnPolicy(findReturnPolicy())
 {
 	for(auto param : streams::stream(decl->param_begin(), decl->param_end()))
 	{
@@ -20,8 +28,205 @@ CallGenerator::CallGenerator(std::string argsRef,
 }
 
 
+CallGenerator::CallGenerator(CallingConvention convention,
+                             const CodegenOptions &options,
+                             const clang::FunctionDecl *decl,
+                             std::string prefix)
+: _unpacker(convention, options)
+, _decl(decl)
+, _prefix(std::move(prefix))
+, _inplaceReturn(options.inplaceReturn)
+, _returnPolicy(findReturnPolicy())
+{
+	for(auto param : streams::stream(decl->param_begin(), decl->param_end()))
+	{
+		_unpacker.addElement(*param);
+	}
+}
+
+
+ReturnPolicy CallGenerator::findReturnPolicy() const
+{
+	static const std::map<std::string, ReturnPolicy> policies = {
+		{"copy",               ReturnPolicy::Copy},
+		{"move",               ReturnPolicy::Move},
+		{"reference",          ReturnPolicy::Reference},
+		{"reference_internal", ReturnPolicy::ReferenceInternal},
+	};
+
+	auto resultTy = _decl->getReturnType();
+
+	for(auto attr : attributeStream(*_decl))
+	{
+		auto annot = attr->getAnnotation();
+		if(!annot.startswith("pyreturn:")) continue;
+
+		auto it = policies.find(annot.split(':').second.str());
+		if(it == policies.end())
+		{
+			diag::stop(*_decl, "return value policy must be one of copy, move, reference "
+			                   "or reference_internal");
+		}
+
+		if(it->second == ReturnPolicy::Reference || it->second == ReturnPolicy::ReferenceInternal)
+		{
+			auto record = resultTy->getPointeeCXXRecordDecl();
+			if(!resultTy->isLValueReferenceType() || !record || !isPyExport(record))
+			{
+				diag::stop(*_decl, "reference return value policies require the function to return "
+				                   "an lvalue reference to an exported class");
+			}
+
+			// wrappers can't keep Python from modifying their objects
+			if(resultTy->getPointeeType().isConstQualified())
+			{
+				diag::stop(*_decl, "reference return value policies require a reference to a "
+				                   "non-const object");
+			}
+		}
+
+		if(it->second == ReturnPolicy::ReferenceInternal)
+		{
+			auto method = llvm::dyn_cast<clang::CXXMethodDecl>(_decl);
+			if(!method || method->isStatic())
+			{
+				diag::stop(*_decl, "the reference_internal return value policy requires a member function");
+			}
+		}
+
+		return it->second;
+	}
+
+	// lvalue references are copied; everything else is ours to move from
+	return resultTy->isLValueReferenceType()? ReturnPolicy::Copy : ReturnPolicy::Move;
+}
+
+
+bool CallGenerator::isNothrow() const
+{
+	auto &ctx = _decl->getASTContext();
+
+	if(!autobind::isNothrow(*_decl))
+	{
+		return false;
+	}
+
+	// copying arguments into by-value parameters happens outside of the callee
+	for(auto param : streams::stream(_decl->param_begin(), _decl->param_end()))
+	{
+		auto ty = param->getType();
+		if(!ty->isReferenceType() && !ty.isTriviallyCopyableType(ctx))
+		{
+			return false;
+		}
+	}
+
+	auto resultTy = _decl->getReturnType();
+	return resultTy->isVoidType() || isNothrowConversion(ctx, resultTy, "dump");
+}
+
+
+bool CallGenerator::isInplace() const
+{
+	if(!_inplaceReturn) return false;
+
+	auto resultTy = _decl->getReturnType();
+	if(resultTy->isReferenceType()) return false;
+
+	// only the generated conversions can allocate a wrapper ahead of time, and only
+	// for classes whose wrappers store their objects
+	auto record = resultTy->getAsCXXRecordDecl();
+	return record && isPyExport(record) && !hasPyHolder(record);
+}
+
+
+void CallGenerator::codegenInplace(std::ostream &out) const
+{
+	static const StringTemplate lean = R"EOF(
+	{{unpack}}
+	
+	if({{ok}})
+	{
+		PyObject *resultObject;
+		void *resultAddress = ::autobind::Conversion<{{type}}>::allocate(&resultObject);
+		if(!resultAddress) return 0;
+
+		new (resultAddress) {{type}}({{prefix}}{{name}}(
+			{{args}}
+		));
+
+		return ::autobind::Conversion<{{type}}>::finishConstruction(resultObject);
+	}
+	)EOF";
+
+	static const StringTemplate top = R"EOF(
+	{{unpack}}
+	
+	if({{ok}})
+	{
+		PyObject *resultObject;
+		void *resultAddress = ::autobind::Conversion<{{type}}>::allocate(&resultObject);
+		if(!resultAddress) return 0;
+
+		try
+		{
+			new (resultAddress) {{type}}({{prefix}}{{name}}(
+				{{args}}
+			));
+
+			PyErr_Clear();
+			return ::autobind::Conversion<{{type}}>::finishConstruction(resultObject);
+		}
+		catch(::autobind::Exception &exc)
+		{
+			Py_DECREF(resultObject);
+			{{pythonException}}
+		}
+		catch(::std::exception &exc)
+		{
+			Py_DECREF(resultObject);
+			{{stdException}}
+		}
+	}
+	)EOF";
+
+	auto ty = _decl->getReturnType().getCanonicalType().getUnqualifiedType();
+
+	(isNothrow()? lean : top).into(out)
+		.setFunc("unpack", method(_unpacker, &TupleUnpacker::codegen))
+		.set("ok", _unpacker.okRef())
+		.set("type", ty.getAsString())
+		.set("prefix", _prefix)
+		.set("name", _decl->getNameAsString())
+		.set("args", streams::cat(streams::stream(_unpacker.elementRefs()) 
+		                          | streams::interposed(",\n")))
+		.setFunc("pythonException", method(*this, &CallGenerator::codegenPythonException))
+		.setFunc("stdException", method(*this, &CallGenerator::codegenStdException))
+		.expand();
+}
+
+
 void CallGenerator::codegen(std::ostream &out) const
 {
+	if(isInplace())
+	{
+		codegenInplace(out);
+		return;
+	}
+
+	static const StringTemplate lean = R"EOF(
+	{{unpack}}
+	
+	if({{ok}})
+	{
+		{{resultDecl}}{{prefix}}{{name}}(
+			{{args}}
+		);
+
+		{{success}}
+	}
+	)EOF";
+
 	static const StringTemplate top = R"EOF(
 	{{unpack}}
 	
@@ -52,7 +257,7 @@ void CallGenerator::codegen(std::ostream &out) const
 		resultDecl = _decl->getReturnType().getAsString() + " result = ";
 	}
 
-	top.into(out)
+	(isNothrow()? lean : top).into(out)
 		.setFunc("unpack", method(_unpacker, &TupleUnpacker::codegen))
 		.set("ok", _unpacker.okRef())
 		.set("prefix", _prefix)
@@ -89,7 +294,10 @@ void CallGenerator::codegenErrorReturn(std::ostream &out) const
 
 void CallGenerator::codegenSuccess(std::ostream &out) const
 {
-	out << "PyErr_Clear();\n";
+	if(!isNothrow())
+	{
+		out << "PyErr_Clear();\n";
+	}
 
 	auto ty = _decl->getReturnType().getNonReferenceType();
 	ty.removeLocalConst();
@@ -102,9 +310,23 @@ void CallGenerator::codegenSuccess(std::ostream &out) const
 	}
 	else
 	{
-		out << "return ::autobind::Conversion<"
-			<< ty.getAsString()
-			<< ">::dump(result);";
+		out << "return ::autobind::Conversion<" << ty.getAsString() << ">::";
+
+		switch(_returnPolicy)
+		{
+		case ReturnPolicy::Copy:
+			out << "dump(result);";
+			break;
+		case ReturnPolicy::Move:
+			out << "dump(::std::move(result));";
+			break;
+		case ReturnPolicy::Reference:
+			out << "reference(result, 0);";
+			break;
+		case ReturnPolicy::ReferenceInternal:
+			out << "reference(result, (PyObject *) self);";
+			break;
+		}
 	}
 }
 
@@ -6,11 +6,32 @@
 
 namespace autobind {
 
+/// How the result of a call is converted to Python (see AB_RETURN).
+enum class ReturnPolicy
+{
+	/// Convert a copy of the result.
+	Copy,
+	/// Convert the result, moving from it.
+	Move,
+	/// Wrap the referenced object without copying it.
+	Reference,
+	/// Wrap the referenced object, and keep `self` alive while the wrapper is.
+	ReferenceInternal
+};
+
 class CallGenerator
 {
 	TupleUnpacker _unpacker;
 	const clang::FunctionDecl *const _decl;
 	std::string _prefix;
+	bool _inplaceReturn = false;
+	ReturnPolicy _returnPolicy;
+
+	/// Read the AB_RETURN annotation of the function, or choose the policy for its
+	/// result type.
+	ReturnPolicy findReturnPolicy() const;
+
+	void codegenInplace(std::ostream &) const;
 protected:
 	virtual void codegenSuccess(std::ostream &) const;
 	virtual void codegenErrorReturn(std::ostream &) const;
@@ -22,8 +43,20 @@ public:
 	              const clang::FunctionDecl *decl,
 	              std::string prefix="");
 
+	CallGenerator(CallingConvention convention,
+	              const CodegenOptions &options,
+	              const clang::FunctionDecl *decl,
+	              std::string prefix="");
+
 	void codegen(std::ostream &) const;
 
+	/// Whether neither the call nor the conversion of its result can throw, so that
+	/// the generated call needs no exception handling.
+	bool isNothrow() const;
+
+	/// Whether the result is constructed directly in its Python wrapper.
+	bool isInplace() const;
+
 	const std::string &okRef() const
 	{
 		return _unpacker.okRef();
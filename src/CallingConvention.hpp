@@ -0,0 +1,46 @@
+// Copyright (c) 2014, Samuel A. Roth. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can
+// be found in the COPYING file.
+
+#ifndef CALLINGCONVENTION_HPP_Q7V3DM
+#define CALLINGCONVENTION_HPP_Q7V3DM
+
+namespace autobind {
+
+/// The ways in which CPython may pass arguments to a generated wrapper.
+enum class CallingConvention
+{
+	VarargsKeywords, ///< METH_VARARGS | METH_KEYWORDS: `args` tuple and `kwargs` dict
+	Fastcall,        ///< METH_FASTCALL | METH_KEYWORDS: `args` array, `nargs` and `kwnames` tuple
+	NoArgs,          ///< METH_NOARGS: no arguments
+	SingleArg        ///< METH_O: a single positional argument, `arg`
+};
+
+/// The PyMethodDef flags for the calling convention.
+inline const char *methodFlags(CallingConvention cc)
+{
+	switch(cc)
+	{
+	case CallingConvention::Fastcall:  return "METH_FASTCALL | METH_KEYWORDS";
+	case CallingConvention::NoArgs:    return "METH_NOARGS";
+	case CallingConvention::SingleArg: return "METH_O";
+	default:                           return "METH_VARARGS | METH_KEYWORDS";
+	}
+}
+
+/// The parameters following `self` in the prototype of a wrapper using the calling convention.
+inline const char *parameterList(CallingConvention cc)
+{
+	switch(cc)
+	{
+	case CallingConvention::Fastcall:  return "PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames";
+	case CallingConvention::NoArgs:    return "PyObject */*unused*/";
+	case CallingConvention::SingleArg: return "PyObject *arg";
+	default:                           return "PyObject *args, PyObject *kwargs";
+	}
+}
+
+} // autobind
+
+#endif // CALLINGCONVENTION_HPP_Q7V3DM
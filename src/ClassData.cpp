@@ -7,6 +7,8 @@
 
 #include "ClassData.hpp"
 #include "util.hpp"
+#include "attributeStream.hpp"
+#include "diagnostics.hpp"
 
 namespace autobind {
 
@@ -17,7 +19,36 @@ ClassData::ClassData(const clang::CXXRecordDecl &decl)
 , _wrapperRef(gensym(decl.getNameAsString()))
 , _typeRef(decl.getQualifiedNameAsString())
 {
-
+	for(auto attr : attributeStream(decl))
+	{
+		auto annot = attr->getAnnotation();
+		if(annot.startswith("pyfreelist:"))
+		{
+			unsigned size;
+			if(annot.split(':').second.getAsInteger(10, size))
+			{
+				diag::stop(decl, "freelist size must be a nonnegative integer");
+			}
+
+			_freelistSize = size;
+		}
+		else if(annot.startswith("pyholder:"))
+		{
+			auto holder = annot.substr(annot.find(':') + 1);
+			if(holder.startswith("std::")) holder = holder.substr(5);
+
+			if(holder != "shared_ptr" && holder != "unique_ptr")
+			{
+				diag::stop(decl, "holder type must be shared_ptr or unique_ptr");
+			}
+
+			_holderType = "std::" + holder.str();
+		}
+		else if(annot == "pyidentity")
+		{
+			_hasRegistry = true;
+		}
+	}
 }
 
 std::string ClassData::exportName() const
@@ -27,7 +58,7 @@ std::string ClassData::exportName() const
 
 bool ClassData::isDefaultConstructible() const
 {
-	return _decl.hasDefaultConstructor();
+	return !_decl.isAbstract() && _decl.hasDefaultConstructor();
 }
 
 
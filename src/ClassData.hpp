@@ -17,6 +17,9 @@ class ClassData
 	const clang::CXXRecordDecl &_decl;
 	const std::string _wrapperRef;
 	const std::string _typeRef;
+	size_t _freelistSize = 0;
+	std::string _holderType;
+	bool _hasRegistry = false;
 public:
 	ClassData(const clang::CXXRecordDecl &decl);
 
@@ -26,6 +29,17 @@ public:
 	std::string exportName() const;
 
 	bool isDefaultConstructible() const;
+
+	/// The number of deallocated wrappers to keep for reuse, from `AB_FREELIST(n)`.
+	/// Zero if the class has no freelist.
+	size_t freelistSize() const { return _freelistSize; }
+
+	/// The smart pointer able to own wrapped objects, from `AB_HOLDER(type)`:
+	/// "std::shared_ptr" or "std::unique_ptr". Empty if the class has no holder.
+	const std::string &holderType() const { return _holderType; }
+
+	/// Whether an object keeps the same wrapper while it has one, from `AB_IDENTITY`.
+	bool hasRegistry() const { return _hasRegistry; }
 };
 
 } // autobind
@@ -0,0 +1,65 @@
+// Copyright (c) 2014, Samuel A. Roth. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can
+// be found in the COPYING file.
+
+#ifndef CODEGENOPTIONS_HPP_5KQ2RW
+#define CODEGENOPTIONS_HPP_5KQ2RW
+
+#include <string>
+
+namespace autobind {
+
+/// Per-module switches selecting between alternative code generation strategies.
+///
+/// Options are enabled from the input file with AB_CODEGEN(name).
+struct CodegenOptions
+{
+	/// Emit METH_FASTCALL | METH_KEYWORDS wrappers (METH_NOARGS or METH_O where every
+	/// overload takes zero or one argument) instead of METH_VARARGS | METH_KEYWORDS.
+	/// Requires Python 3.7 or later.
+	bool fastcall = false;
+
+	/// Unpack arguments with straight-line code specialized for each parameter, rather
+	/// than with PyArg_ParseTupleAndKeywords and its runtime format string interpreter.
+	bool inlineUnpack = false;
+
+	/// Construct exported classes returned by value directly in a newly allocated
+	/// wrapper, rather than converting a temporary. This also allows returning
+	/// objects that cannot be copied.
+	bool inplaceReturn = false;
+
+	/// Enable the option with the given name. Returns false if there is no such option.
+	bool enable(const std::string &name)
+	{
+		if(name == "fastcall")
+		{
+			fastcall = true;
+		}
+		else if(name == "inline_unpack")
+		{
+			inlineUnpack = true;
+		}
+		else if(name == "inplace_return")
+		{
+			inplaceReturn = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	/// The options used when a module does not specify any.
+	static const CodegenOptions &defaults()
+	{
+		static const CodegenOptions result;
+		return result;
+	}
+};
+
+} // autobind
+
+#endif // CODEGENOPTIONS_HPP_5KQ2RW
@@ -269,6 +269,25 @@ public:
 			_modstack.back()->setDocstring(ann.split(':').second);
 		}
 
+		auto codegenStream = attributeStream(*decl)
+			| filtered([](const clang::AnnotateAttr *a) { return a->getAnnotation().startswith("py:codegen:"); });
+
+		for(auto attr : codegenStream)
+		{
+			if(!checkInModule(decl)) return false;
+
+			auto option = attr->getAnnotation().rsplit(':').second;
+			if(!_modstack.back()->options().enable(option))
+			{
+				auto &diags = decl->getASTContext().getDiagnostics();
+				unsigned id = diags.getCustomDiagID(clang::DiagnosticsEngine::Error,
+				                                    "unknown code generation option '%0'");
+
+				diags.Report(decl->getLocation(), id) << option;
+				return false;
+			}
+		}
+
 
 		return true;
 	}
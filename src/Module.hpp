@@ -1,6 +1,7 @@
 #ifndef MODULE_HPP_FN116U
 #define MODULE_HPP_FN116U
 #include "Export.hpp"
+#include "CodegenOptions.hpp"
 
 namespace autobind {
 
@@ -9,6 +10,7 @@ class Module
 	std::string _name;
 	std::string _sourceTUPath;
 	std::string _docstring;
+	CodegenOptions _options;
 	std::unordered_map<std::string, std::unique_ptr<Export>> _exports;
 public:
 	void setDocstring(const std::string &docstring)
@@ -16,6 +18,16 @@ public:
 		_docstring = docstring;
 	}
 
+	CodegenOptions &options()
+	{
+		return _options;
+	}
+
+	const CodegenOptions &options() const
+	{
+		return _options;
+	}
+
 	void addExport(std::unique_ptr<Export> e)
 	{
 		e->setModule(*this);
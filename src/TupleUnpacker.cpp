@@ -10,8 +10,58 @@
 
 #include <clang/AST/ASTContext.h>
 
+#include <algorithm>
+#include <map>
+
 namespace autobind {
 
+namespace {
+
+/// The check for the exact Python type of the values of an arithmetic type that 
+/// is unpacked without going through its Conversion<>, or null if it isn't. `int` 
+/// is left to the "i" format.
+const char *scalarExactCheck(const clang::Type *ty)
+{
+	auto builtin = llvm::dyn_cast<clang::BuiltinType>(ty);
+	if(!builtin) return nullptr;
+
+	switch(builtin->getKind())
+	{
+	case clang::BuiltinType::Bool:
+		// bool cannot be subclassed
+		return "PyBool_Check";
+	case clang::BuiltinType::SChar:
+	case clang::BuiltinType::UChar:
+	case clang::BuiltinType::Short:
+	case clang::BuiltinType::UShort:
+	case clang::BuiltinType::UInt:
+	case clang::BuiltinType::Long:
+	case clang::BuiltinType::ULong:
+	case clang::BuiltinType::LongLong:
+	case clang::BuiltinType::ULongLong:
+		return "PyLong_CheckExact";
+	case clang::BuiltinType::Float:
+	case clang::BuiltinType::Double:
+	case clang::BuiltinType::LongDouble:
+		return "PyFloat_CheckExact";
+	default:
+		return nullptr;
+	}
+}
+
+} // namespace
+
+bool TupleUnpacker::isUnpackedDirectly(const clang::VarDecl &decl)
+{
+	auto &ctx = decl.getASTContext();
+	auto ty = decl.getType().getCanonicalType().getNonReferenceType().getUnqualifiedType();
+
+	return scalarExactCheck(ty.getTypePtr())
+		|| ty == ctx.IntTy
+		|| ty == ctx.getPointerType(ctx.getConstType(ctx.CharTy));
+}
+
+
 void TupleUnpacker::addElement(const clang::VarDecl &decl)
 {
 	auto &ctx = decl.getASTContext();
@@ -31,9 +81,20 @@ void TupleUnpacker::addElement(const clang::VarDecl &decl)
 
 	StorageElt elt;
 
-	if(unqualType == constCharStarTy)
+	if(auto exactCheck = scalarExactCheck(unqualType))
+	{
+		_format += "O&";
+		elt.format = "O&";
+		elt.type = unqualQType.getAsString();
+		elt.name = argIdent;
+		elt.scalarType = elt.type;
+		elt.exactCheck = exactCheck;
+		_elementRefs.push_back(argIdent);
+	}
+	else if(unqualType == constCharStarTy)
 	{
 		_format += "s";
+		elt.format = "s";
 		elt.type = "const char *";
 		elt.name = argIdent;
 		_elementRefs.push_back(argIdent);
@@ -41,6 +102,7 @@ void TupleUnpacker::addElement(const clang::VarDecl &decl)
 	else if(unqualType == intTy)
 	{
 		_format += "i";
+		elt.format = "i";
 		elt.type = "int";
 		elt.name = argIdent;
 		_elementRefs.push_back(argIdent);
@@ -48,7 +110,8 @@ void TupleUnpacker::addElement(const clang::VarDecl &decl)
 	else
 	{
 		_format += "O&";
-		elt.type = "::autobind::detail::ConversionFunc<"
+		elt.format = "O&";
+		elt.type = "::autobind::python::detail::ConversionFunc<"
 		                              + unqualQType.getAsString() + ">::Value";
 		elt.name = argIdent;
 		elt.msg = ("expected object convertible to " + unqualQType.getAsString() + " for argument "
@@ -74,7 +137,349 @@ const std::string &TupleUnpacker::okRef() const
 }
 
 
+std::string TupleUnpacker::storageDecls() const
+{
+	using namespace streams;
+
+	auto decls = stream(_storageElements)
+		| transformed([&](const StorageElt &e) {
+			auto result = e.type + " " + e.name + ";\n";
+			if(!e.msg.empty())
+			{
+				// We control this string so we don't need to worry about escaping it here.
+				result += e.name + ".errorMessage = \"" + e.msg + "\";\n"; 
+			}
+
+			return result;
+		});
+
+	return cat(decls).toString();
+}
+
+
+std::string TupleUnpacker::conversionExpr(const StorageElt &e, const std::string &slot) const
+{
+	if(!e.scalarType.empty())
+	{
+		return "(" + e.exactCheck + "(" + slot + ")? "
+			+ "::autobind::python::detail::unpackExactScalar(" + slot + ", &" + e.name + ") : "
+			+ "::autobind::python::detail::unpackArgument(" + slot + ", &" + e.name + "))";
+	}
+	else if(!e.realType.empty())
+	{
+		return "::autobind::python::detail::ConversionFunc<" + e.realType + ">::convert(" + slot + ", &" + e.name + ")";
+	}
+	else if(!_inline)
+	{
+		return "PyArg_Parse(" + slot + ", \"" + e.format + "\", &" + e.name + ")";
+	}
+	else
+	{
+		static const std::map<std::string, std::pair<std::string, std::string>> exactPaths = {
+			{"i", {"PyLong_CheckExact", "::autobind::python::detail::unpackExactInt"}},
+			{"s", {"PyUnicode_CheckExact", "::autobind::python::detail::unpackExactString"}},
+		};
+
+		const auto &exact = exactPaths.at(e.format);
+		return "(" + exact.first + "(" + slot + ")? " 
+			+ exact.second + "(" + slot + ", &" + e.name + ") : " 
+			+ "::autobind::python::detail::unpackArgument(" + slot + ", &" + e.name + "))";
+	}
+}
+
+
+std::string TupleUnpacker::positionalCountExpr() const
+{
+	switch(_convention)
+	{
+	case CallingConvention::Fastcall:  return "nargs";
+	case CallingConvention::NoArgs:    return "0";
+	case CallingConvention::SingleArg: return "1";
+	default:                           return "PyTuple_GET_SIZE(" + _argsRef + ")";
+	}
+}
+
+
+std::string TupleUnpacker::keywordCountExpr() const
+{
+	switch(_convention)
+	{
+	case CallingConvention::Fastcall:
+		return "(" + _kwargsRef + "? PyTuple_GET_SIZE(" + _kwargsRef + ") : 0)";
+	case CallingConvention::VarargsKeywords:
+		return "(" + _kwargsRef + "? PyDict_Size(" + _kwargsRef + ") : 0)";
+	default:
+		return "0";
+	}
+}
+
+
+std::string TupleUnpacker::positionalExpr(size_t index) const
+{
+	auto i = std::to_string(index);
+
+	switch(_convention)
+	{
+	case CallingConvention::Fastcall:  return _argsRef + "[" + i + "]";
+	case CallingConvention::SingleArg: return _argsRef;
+	default:                           return "PyTuple_GET_ITEM(" + _argsRef + ", " + i + ")";
+	}
+}
+
+
+std::string TupleUnpacker::positionalArrayExpr() const
+{
+	switch(_convention)
+	{
+	case CallingConvention::Fastcall:  return _argsRef;
+	case CallingConvention::SingleArg: return "&" + _argsRef;
+	case CallingConvention::NoArgs:    return "0";
+	default:                           return "PySequence_Fast_ITEMS(" + _argsRef + ")";
+	}
+}
+
+
+std::string TupleUnpacker::viabilityCheck() const
+{
+	using namespace streams;
+
+	static const std::map<std::string, std::string> typeChecks = {
+		{"i", "PyIndex_Check"},
+		{"s", "PyUnicode_Check"},
+	};
+
+	std::vector<std::string> checks;
+
+	if(_convention == CallingConvention::Fastcall 
+	   || _convention == CallingConvention::VarargsKeywords)
+	{
+		auto names = stream(_argNames)
+			| transformed([&](const std::string &n) { return "\"" + n + "\""; })
+			| interposed(", ");
+
+		checks.push_back("(!" + keywordCountExpr() + " || ::autobind::python::detail::keywordsMatch(" 
+		                 + _kwargsRef + ", " + positionalCountExpr() + ", {" + cat(names).toString() + "}))");
+	}
+
+	for(size_t i = 0; i < _storageElements.size(); ++i)
+	{
+		const auto &e = _storageElements[i];
+		auto arg = positionalExpr(i);
+		auto check = !e.scalarType.empty()? "::autobind::python::detail::mayUnpack<" + e.scalarType + ">(" + arg + ")"
+		           : e.realType.empty()? typeChecks.at(e.format) + "(" + arg + ")"
+		           : "::autobind::python::detail::mayLoad<" + e.realType + ">(" + arg + ")";
+
+		if(_convention == CallingConvention::SingleArg)
+		{
+			checks.push_back(check);
+		}
+		else
+		{
+			checks.push_back("(" + positionalCountExpr() + " <= " + std::to_string(i) + " || " + check + ")");
+		}
+	}
+
+	if(checks.empty())
+	{
+		return "true";
+	}
+
+	return cat(stream(checks) | interposed("\n&& ")).toString();
+}
+
+
 void TupleUnpacker::codegen(std::ostream &out) const
+{
+	if(_inline && (_convention == CallingConvention::Fastcall 
+	               || _convention == CallingConvention::VarargsKeywords))
+	{
+		codegenInline(out);
+		return;
+	}
+
+	switch(_convention)
+	{
+	case CallingConvention::Fastcall:
+		codegenFastcall(out);
+		break;
+	case CallingConvention::NoArgs:
+		codegenNoArgs(out);
+		break;
+	case CallingConvention::SingleArg:
+		codegenSingleArg(out);
+		break;
+	default:
+		codegenVarargsKeywords(out);
+		break;
+	}
+}
+
+
+void TupleUnpacker::codegenFastcall(std::ostream &out) const
+{
+	using namespace streams;
+
+	static const StringTemplate top = R"EOF(
+	
+	static const char *{{kwlist}}[] = {
+		{{argnames}}
+		0
+	};
+
+	PyObject *{{slots}}[{{slotCount}}];
+	{{decls}}
+
+	int {{ok}} = ::autobind::python::detail::gatherArguments(
+		{{args}},
+		{{nargs}},
+		{{kw}},
+		{{kwlist}},
+		{{count}},
+		{{slots}}
+	){{conversions}};
+
+	)EOF";
+
+	auto kwlistSym = gensym("kwlist");
+	auto slotsSym = gensym("slots");
+
+	auto argnames = stream(_argNames)
+		| transformed([&](const std::string &n) {
+			return "\"" + n + "\", ";
+		});
+
+	std::string conversions;
+	for(size_t i = 0; i < _storageElements.size(); ++i)
+	{
+		conversions += "\n&& " + conversionExpr(_storageElements[i], 
+		                                        slotsSym + "[" + std::to_string(i) + "]");
+	}
+
+	top.into(out)
+		.set("kwlist", kwlistSym)
+		.set("argnames", cat(argnames))
+		.set("slots", slotsSym)
+		// zero-length arrays aren't standard C++
+		.set("slotCount", std::max<size_t>(_storageElements.size(), 1))
+		.set("count", _storageElements.size())
+		.set("decls", storageDecls())
+		.set("ok", _okRef)
+		.set("args", _argsRef)
+		.set("nargs", "nargs")
+		.set("kw", _kwargsRef)
+		.set("conversions", conversions)
+		.expand();
+}
+
+
+void TupleUnpacker::codegenInline(std::ostream &out) const
+{
+	using namespace streams;
+
+	static const StringTemplate top = R"EOF(
+	
+	static const char *{{kwlist}}[] = {
+		{{argnames}}
+		0
+	};
+	static const ::autobind::python::detail::KeywordNames<{{count}}> {{names}}({{kwlist}});
+
+	PyObject *{{slots}}[{{slotCount}}];
+	{{decls}}
+
+	int {{ok}} = {{positionalOnly}};
+	if({{ok}})
+	{
+		{{positional}}
+	}
+	else
+	{
+		{{ok}} = {{names}}.gather({{gatherArgs}}, {{slots}});
+	}
+
+	{{conversions}}
+
+	)EOF";
+
+	const bool fastcall = _convention == CallingConvention::Fastcall;
+	const auto count = _storageElements.size();
+
+	auto kwlistSym = gensym("kwlist");
+	auto namesSym = gensym("names");
+	auto slotsSym = gensym("slots");
+
+	auto argnames = stream(_argNames)
+		| transformed([&](const std::string &n) {
+			return "\"" + n + "\", ";
+		});
+
+	std::string positionalOnly, positional, gatherArgs, conversions;
+	if(fastcall)
+	{
+		positionalOnly = "nargs == " + std::to_string(count)
+			+ " && (!" + _kwargsRef + " || !PyTuple_GET_SIZE(" + _kwargsRef + "))";
+		gatherArgs = _argsRef + ", nargs, " + _kwargsRef;
+	}
+	else
+	{
+		positionalOnly = "PyTuple_GET_SIZE(" + _argsRef + ") == " + std::to_string(count)
+			+ " && (!" + _kwargsRef + " || !PyDict_Size(" + _kwargsRef + "))";
+		gatherArgs = _argsRef + ", " + _kwargsRef;
+	}
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		auto index = std::to_string(i);
+		auto slot = slotsSym + "[" + index + "]";
+
+		positional += slot + " = " 
+			+ (fastcall? _argsRef + "[" + index + "]" 
+			           : "PyTuple_GET_ITEM(" + _argsRef + ", " + index + ")")
+			+ ";\n";
+
+		conversions += "\n&& " + conversionExpr(_storageElements[i], slot);
+	}
+
+	if(count)
+	{
+		conversions = _okRef + " = " + _okRef + conversions + ";";
+	}
+
+	top.into(out)
+		.set("kwlist", kwlistSym)
+		.set("argnames", cat(argnames))
+		.set("count", count)
+		.set("names", namesSym)
+		.set("slots", slotsSym)
+		// zero-length arrays aren't standard C++
+		.set("slotCount", std::max<size_t>(count, 1))
+		.set("decls", storageDecls())
+		.set("ok", _okRef)
+		.set("positionalOnly", positionalOnly)
+		.set("positional", positional)
+		.set("gatherArgs", gatherArgs)
+		.set("conversions", conversions)
+		.expand();
+}
+
+
+void TupleUnpacker::codegenNoArgs(std::ostream &out) const
+{
+	assert(_storageElements.empty());
+	out << "int " << _okRef << " = 1;\n";
+}
+
+
+void TupleUnpacker::codegenSingleArg(std::ostream &out) const
+{
+	assert(_storageElements.size() == 1);
+
+	out << storageDecls();
+	out << "int " << _okRef << " = " << conversionExpr(_storageElements.front(), _argsRef) << ";\n";
+}
+
+
+void TupleUnpacker::codegenVarargsKeywords(std::ostream &out) const
 {
 	using namespace streams;
 
@@ -104,23 +509,15 @@ void TupleUnpacker::codegen(std::ostream &out) const
 			return "\"" + n + "\", ";
 		});
 
-	auto decls = stream(_storageElements)
+	auto elements = stream(_storageElements)
 		| transformed([&](const StorageElt &e) {
-			auto result = e.type + " " + e.name + ";\n";
-			if(!e.msg.empty())
+			if(!e.scalarType.empty())
 			{
-				// We control this string so we don't need to worry about escaping it here.
-				result += e.name + ".errorMessage = \"" + e.msg + "\";\n"; 
+				return ",\n &::autobind::python::detail::convertScalar<" + e.scalarType + ">, &" + e.name;
 			}
-
-			return result;
-		});
-
-	auto elements = stream(_storageElements)
-		| transformed([&](const StorageElt &e) {
-			if(!e.realType.empty()) // this could be done more elegantly
+			else if(!e.realType.empty()) // this could be done more elegantly
 			{
-				return ",\n &::autobind::detail::ConversionFunc<" + e.realType + ">::convert, &" + e.name;
+				return ",\n &::autobind::python::detail::ConversionFunc<" + e.realType + ">::convert, &" + e.name;
 			}
 			else
 			{
@@ -131,7 +528,7 @@ void TupleUnpacker::codegen(std::ostream &out) const
 	top.into(out)
 		.set("kwlist", kwlistSym)
 		.set("argnames", cat(argnames))
-		.set("decls", cat(decls))
+		.set("decls", storageDecls())
 		.set("ok", _okRef)
 		.set("args", _argsRef)
 		.set("kw", _kwargsRef)
@@ -143,5 +540,3 @@ void TupleUnpacker::codegen(std::ostream &out) const
 
 
 } // autobind
-
-
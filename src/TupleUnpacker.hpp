@@ -8,6 +8,8 @@
 #include <string>
 #include <clang/AST/Decl.h>
 #include "util.hpp"
+#include "CallingConvention.hpp"
+#include "CodegenOptions.hpp"
 namespace autobind {
 
 /// Generates code for unpacking a Python argument tuple.
@@ -18,24 +20,59 @@ class TupleUnpacker
 		std::string type, name;
 		std::string msg;
 		std::string realType;
+		std::string format;
+
+		/// The arithmetic type unpacked by `detail::unpackArgument()`, if any, 
+		/// and the test for the Python type whose values it unpacks fastest.
+		std::string scalarType;
+		std::string exactCheck;
 	};
 
+	const CallingConvention _convention;
+	const bool _inline;
 	const std::string _argsRef, _kwargsRef;
 	const std::string _okRef;
 	std::string _format;
 	std::vector<StorageElt> _storageElements;
 	std::vector<std::string> _elementRefs;
 	std::vector<std::string> _argNames;
+
+	void codegenVarargsKeywords(std::ostream &) const;
+	void codegenFastcall(std::ostream &) const;
+	void codegenNoArgs(std::ostream &) const;
+	void codegenSingleArg(std::ostream &) const;
+	void codegenInline(std::ostream &) const;
+
+	/// Generate an expression converting the object `slot` into the given element,
+	/// evaluating to nonzero on success.
+	std::string conversionExpr(const StorageElt &, const std::string &slot) const;
+	std::string storageDecls() const;
 public:
 	/// Initialize the TupleUnpacker given the names of the variables containing
 	/// args and kwargs.
 	TupleUnpacker(std::string argsRef,
 	              std::string kwargsRef)
-	: _argsRef(std::move(argsRef))
+	: _convention(CallingConvention::VarargsKeywords)
+	, _inline(false)
+	, _argsRef(std::move(argsRef))
 	, _kwargsRef(std::move(kwargsRef))
 	, _okRef(gensym("ok"))
 	{ }
 
+	/// Initialize the TupleUnpacker for a wrapper using the given calling convention.
+	/// The arguments are expected in the variables named by parameterList().
+	TupleUnpacker(CallingConvention convention,
+	              const CodegenOptions &options)
+	: _convention(convention)
+	, _inline(options.inlineUnpack)
+	, _argsRef(convention == CallingConvention::SingleArg? "arg" : "args")
+	, _kwargsRef(convention == CallingConvention::Fastcall? "kwnames" : "kwargs")
+	, _okRef(gensym("ok"))
+	{ }
+
+
+	/// Whether a parameter of this type is unpacked without its Conversion<>.
+	static bool isUnpackedDirectly(const clang::VarDecl &decl);
 
 	/// Add a variable declaration to the list of values to be unpacked from the tuple.
 	/// (The type and name of the variable declaration will be used.)
@@ -49,6 +86,23 @@ public:
 
 	/// Generate the code for the tuple unpack.
 	void codegen(std::ostream &) const;
+
+	/// An expression giving the number of positional arguments.
+	std::string positionalCountExpr() const;
+
+	/// An expression giving the number of keyword arguments.
+	std::string keywordCountExpr() const;
+
+	/// An expression referring to the positional argument at `index`.
+	std::string positionalExpr(size_t index) const;
+
+	/// An expression giving a `PyObject *const *` to the positional arguments.
+	std::string positionalArrayExpr() const;
+
+	/// Generate a cheap expression that is false if the arguments certainly cannot be
+	/// unpacked, assuming the total number of arguments is the number of elements.
+	/// It checks keyword names and the types of positional arguments, without raising.
+	std::string viabilityCheck() const;
 };
 
 
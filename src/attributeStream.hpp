@@ -14,7 +14,7 @@
 namespace autobind {
 
 
-AB_RETURN_AUTO(inline attributeStream(clang::Decl &x),
+AB_RETURN_AUTO(inline attributeStream(const clang::Decl &x),
                streams::stream(x.specific_attr_begin<clang::AnnotateAttr>(),
                                x.specific_attr_end<clang::AnnotateAttr>()))
 
@@ -35,6 +35,22 @@ inline bool isPyNoExport(clang::Decl *d)
 	return any(attributeStream(*d) | transformed(pred));
 }
 
+inline bool isPyView(const clang::Decl *d)
+{
+	using namespace streams;
+
+	auto pred = [](const clang::AnnotateAttr *a) { return a->getAnnotation() == "pyview"; };
+	return any(attributeStream(*d) | transformed(pred));
+}
+
+inline bool hasPyHolder(const clang::Decl *d)
+{
+	using namespace streams;
+
+	auto pred = [](const clang::AnnotateAttr *a) { return a->getAnnotation().startswith("pyholder:"); };
+	return any(attributeStream(*d) | transformed(pred));
+}
+
 } // autobind
 
 
@@ -22,11 +22,13 @@ Class::Class(const clang::CXXRecordDecl &decl)
 , _decl(decl)
 , _classData(decl)
 , _constructor(_classData)
+, _vectorcallConstructor(_classData, _constructor)
 {
 	_selfTypeRef = _classData.wrapperRef();
 
 	using namespace streams;
 	_constructor.setSelfTypeRef(_selfTypeRef);
+	_vectorcallConstructor.setSelfTypeRef(_selfTypeRef);
 	for(auto it = decl.method_begin(), end = decl.method_end(); it != end; ++it)
 	{
 		auto kind = it->getKind();
@@ -34,10 +36,12 @@ Class::Class(const clang::CXXRecordDecl &decl)
 		{
 			auto constructor = llvm::dyn_cast_or_null<clang::CXXConstructorDecl>(*it);
 			
+			// abstract classes can only be wrapped through a holder (see AB_HOLDER)
 			if(!constructor->isCopyConstructor() && !constructor->isMoveConstructor()
-			   && constructor->getAccess() == clang::AS_public)
+			   && constructor->getAccess() == clang::AS_public && !decl.isAbstract())
 			{
 				_constructor.addDecl(*constructor);
+				_vectorcallConstructor.addDecl(*constructor);
 			}
 		}
 		else if(kind == clang::CXXMethodDecl::CXXDestructor)
@@ -46,7 +50,8 @@ Class::Class(const clang::CXXRecordDecl &decl)
 		}
 		else if(!it->isStatic() 
 		        && it->getAccess() == clang::AS_public 
-		        && !it->isOverloadedOperator())
+		        && !it->isOverloadedOperator()
+		        && !isPyNoExport(*it))
 		{
 			auto name = it->getNameAsString();
 
@@ -110,6 +115,17 @@ void Class::mergeClassExport(std::unique_ptr<ClassExport> ex)
 }
 
 
+void Class::setModule(Module &module)
+{
+	_constructor.setModule(module);
+	_vectorcallConstructor.setModule(module);
+	for(const auto &e : _exports)
+	{
+		e.second->setModule(module);
+	}
+}
+
+
 void Class::codegenDeclaration(std::ostream &out) const
 {
 	static const StringTemplate tpl = R"EOF(
@@ -133,43 +149,110 @@ void Class::codegenDeclaration(std::ostream &out) const
 		e.second->codegenDeclaration(out);
 	}
 
-	// TODO: handle noncopyable types
 	static const StringTemplate converterTemplate = R"EOF(
 	template <>
 	struct autobind::Conversion<{{typeName}}>
 	{
-		static PyObject *dump(const {{typeName}} &obj);
+		static PyObject *dump(const {{typeName}} &obj) noexcept;
+		static PyObject *dump({{typeName}} &&obj) noexcept;
 		static {{typeName}} &load(PyObject *obj);
-
+		static bool tryLoad(PyObject *obj, autobind::Optional<{{typeName}} &> &result) noexcept;
+		static bool check(PyObject *obj) noexcept;
+		static PyObject *reference({{typeName}} &obj, PyObject *parent) noexcept;
+		{{storageMembers}}
 	};
 	)EOF";
 
+	auto &holderType = _classData.holderType();
+
 	converterTemplate.into(out)
 		.set("typeName", _decl.getQualifiedNameAsString())
+		.setFunc("storageMembers", [&](std::ostream &out) {
+			auto typeName = _decl.getQualifiedNameAsString();
+			if(holderType.empty())
+			{
+				// for inplace_return
+				out << "static void *allocate(PyObject **wrapper) noexcept;\n"
+				    << "static PyObject *finishConstruction(PyObject *wrapper) noexcept;\n";
+				return;
+			}
+
+			out << "static PyObject *adopt(" << holderType << "<" << typeName << "> &&holder) noexcept;\n";
+			if(holderType == "std::shared_ptr")
+			{
+				out << "static std::shared_ptr<" << typeName << "> share(PyObject *obj);\n";
+			}
+		})
 		.expand();
 }
 
 
 void Class::codegenDefinition(std::ostream &out) const
 {
-	static const StringTemplate tpl = R"EOF(
-
+	static const StringTemplate inlineStructTemplate = R"EOF(
 	struct {{selfTypeRef}}
 	{
 		PyObject_HEAD
 		bool initialized;
-		{{wrappedType}} object;
+
+		// Whether the wrapper was allocated without room for `value`, as wrappers of
+		// references are.
+		bool compact;
+
+		// The wrapped object: `value`, or an object owned by C++ code (or by `parent`).
+		{{wrappedType}} *object;
+		PyObject *parent;
+	};
+
+	// A wrapper that can store its object. The type's tp_basicsize is that of this.
+	struct {{selfTypeRef}}_Inline: {{selfTypeRef}}
+	{
+		{{wrappedType}} value;
 	};
+	)EOF";
+
+	// Objects of classes with AB_HOLDER are always stored elsewhere, which allows
+	// the classes to be abstract.
+	static const StringTemplate holderStructTemplate = R"EOF(
+	struct {{selfTypeRef}}
+	{
+		PyObject_HEAD
+
+		// The wrapped object: owned by `holder`, or by C++ code (or by `parent`).
+		{{wrappedType}} *object;
+		PyObject *parent;
+		::autobind::Optional<{{holderType}}<{{wrappedType}}> > holder;
+	};
+	)EOF";
+
+	static const StringTemplate tpl = R"EOF(
+	{{struct}}
 
 	static int {{selfTypeRef}}_init({{selfTypeRef}} *self, PyObject *args, PyObject *kw)
 	{
 		return 0;
 	}
 
+	{{registry}}
+
+	// Initialize the members of a newly allocated wrapper other than its object. 
+	// Its memory may be reused from a deallocated wrapper (see AB_FREELIST).
+	static void {{selfTypeRef}}_prepare({{selfTypeRef}} *self)
+	{
+		{{prepare}}
+	}
+
+	// Record that `self` wraps its object, for AB_IDENTITY.
+	static void {{selfTypeRef}}_track({{selfTypeRef}} *self)
+	{
+		{{track}}
+	}
+
 	static void {{selfTypeRef}}_dealloc({{selfTypeRef}} *self)
 	{
-		if(self->initialized)
-			self->object.{{destructor}}();
+		{{untrack}}
+		{{release}}
+		Py_XDECREF(self->parent);
 		Py_TYPE(self)->tp_free((PyObject *)self);
 	}
 
@@ -180,17 +263,67 @@ void Class::codegenDefinition(std::ostream &out) const
 
 	static PyGetSetDef {{selfTypeRef}}_getset[] = {
 		{{getSetTable}}
+		::autobind::protocols::detail::ArrayInterface<{{wrappedType}}, {{selfTypeRef}}>::getset(),
 		{0}
 	};
 
 	)EOF";
 
 	auto wrappedTypeName = _decl.getQualifiedNameAsString();
+	auto &holderType = _classData.holderType();
 
 	tpl.into(out)
 		.set("wrappedType", wrappedTypeName)
 		.set("selfTypeRef", _selfTypeRef)
-		.set("destructor", "~" + wrappedTypeName)
+		.setFunc("struct", [&](std::ostream &out) {
+			(holderType.empty()? inlineStructTemplate : holderStructTemplate).into(out)
+				.set("wrappedType", wrappedTypeName)
+				.set("selfTypeRef", _selfTypeRef)
+				.set("holderType", holderType)
+				.expand();
+		})
+		.setFunc("prepare", [&](std::ostream &out) {
+			if(holderType.empty())
+			{
+				out << "self->initialized = false;\n"
+				    << "self->compact = false;\n";
+				return;
+			}
+
+			out << "new ((void *) &self->holder) ::autobind::Optional<" 
+			    << holderType << "<" << wrappedTypeName << "> >();\n";
+		})
+		.setFunc("registry", [&](std::ostream &out) {
+			if(_classData.hasRegistry())
+			{
+				out << "static ::autobind::python::detail::Registry " << _selfTypeRef << "_registry;\n";
+			}
+		})
+		.setFunc("track", [&](std::ostream &out) {
+			if(_classData.hasRegistry())
+			{
+				out << _selfTypeRef << "_registry.add(self->object, (PyObject *) self);\n";
+			}
+		})
+		.setFunc("untrack", [&](std::ostream &out) {
+			// first, as the destructor of the object could run code that looks it up
+			if(_classData.hasRegistry())
+			{
+				out << _selfTypeRef << "_registry.remove(self->object, (PyObject *) self);\n";
+			}
+		})
+		.setFunc("release", [&](std::ostream &out) {
+			if(holderType.empty())
+			{
+				out << "if(self->initialized)\n"
+				    << "\t((" << _selfTypeRef << "_Inline *) self)->value.~" << wrappedTypeName << "();\n";
+				return;
+			}
+
+			// the holder is reset rather than destroyed, as the next wrapper to use this
+			// memory constructs it again
+			out << "self->holder.reset();\n";
+		})
 		.setFunc("methodTable", [&](std::ostream &out) {
 			for(const auto &e : _exports)
 			{
@@ -211,13 +344,20 @@ void Class::codegenDefinition(std::ostream &out) const
 	}
 
 	_constructor.codegenDefinition(out);
+	_vectorcallConstructor.codegenDefinition(out);
 
 
 	static const StringTemplate typeObjectTemplate = R"EOF(
+	typedef ::autobind::python::detail::ObjectAllocator<alignof({{objectStruct}})> {{structName}}_Allocator;
+
+	// Python subclasses are allocated without regard to the alignment of the object.
+	static const unsigned long {{structName}}_BaseTypeFlag = 
+		alignof({{objectStruct}}) > ::autobind::python::detail::objectAlignment? 0 : Py_TPFLAGS_BASETYPE;
+
 	static PyTypeObject {{structName}}_Type = {
 		PyVarObject_HEAD_INIT(NULL, 0)                     
 		"{{moduleName}}.{{name}}",                                                    /* tp_name */
-		sizeof({{structName}}),                                                       /* tp_basicsize */
+		sizeof({{objectStruct}}),                                                     /* tp_basicsize */
 		0,                                                                            /* tp_itemsize */       
 		(destructor){{structName}}_dealloc,                                           /* tp_dealloc */
 		0,                                                                            /* tp_print */          
@@ -234,7 +374,7 @@ void Class::codegenDefinition(std::ostream &out) const
 		PyObject_GenericGetAttr,                                                      /* tp_getattro */       
 		PyObject_GenericSetAttr,                                                      /* tp_setattro */       
 		autobind::protocols::detail::BufferProcs<{{cppName}}, {{structName}}>::get(),   /* tp_as_buffer */      
-		Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,                                     /* tp_flags */          
+		Py_TPFLAGS_DEFAULT | {{structName}}_BaseTypeFlag,                             /* tp_flags */          
 		"{{docstring}}",                                                              /* tp_doc */
 		0,                                                                            /* tp_traverse */       
 		0,                                                                            /* tp_clear */          
@@ -268,6 +408,7 @@ void Class::codegenDefinition(std::ostream &out) const
 
 	typeObjectTemplate.into(out)
 		.set("structName", _selfTypeRef)
+		.set("objectStruct", holderType.empty()? _selfTypeRef + "_Inline" : _selfTypeRef)
 		.set("moduleName", _moduleName)
 		.set("name", name())
 		.set("cppName", _decl.getQualifiedNameAsString())
@@ -276,19 +417,58 @@ void Class::codegenDefinition(std::ostream &out) const
 		.set("constructorRef", _constructor.implRef())
 		.expand();
 		
-	// TODO: handle noncopyables
+	if(_classData.freelistSize() > 0)
+	{
+		// These replace the tp_alloc and tp_free of the type, but leave subclasses alone.
+		static const StringTemplate freelistTemplate = R"EOF(
+		static ::autobind::python::detail::Freelist<{{size}}> {{structName}}_freelist;
 
-	static const StringTemplate conversionImplTemplate = R"EOF(
-		PyObject * autobind::Conversion<{{typeName}}>::dump(const {{typeName}} &obj)
+		static PyObject *{{structName}}_alloc(PyTypeObject *ty, Py_ssize_t nitems)
+		{
+			PyObject *obj = ty == &{{structName}}_Type? {{structName}}_freelist.pop(ty) : 0;
+			if(!obj) return {{structName}}_Allocator::alloc(ty, nitems);
+
+			// the rest is set up by {{structName}}_prepare(), or constructed before it is read
+			(({{structName}} *) obj)->object = 0;
+			(({{structName}} *) obj)->parent = 0;
+			return obj;
+		}
+
+		static void {{structName}}_free(void *ptr)
+		{
+			PyObject *obj = (PyObject *) ptr;
+			if(Py_TYPE(obj) != &{{structName}}_Type || !({{reusable}}{{structName}}_freelist.push(obj)))
+			{
+				{{structName}}_Allocator::free(ptr);
+			}
+		}
+		)EOF";
+
+		freelistTemplate.into(out)
+			.set("structName", _selfTypeRef)
+			.set("size", _classData.freelistSize())
+			.setFunc("reusable", [&](std::ostream &out) {
+				// compact wrappers are too small for the next wrapper to use
+				if(holderType.empty()) out << "!((" << _selfTypeRef << " *) obj)->compact && ";
+			})
+			.expand();
+	}
+
+	static const StringTemplate createTemplate = R"EOF(
+		// Allocate a wrapper and give it an object made by `construct`.
+		template <class Construct>
+		static PyObject *{{structName}}_create(const Construct &construct) noexcept
 		{
 			PyTypeObject *ty = &{{structName}}_Type;
 			
 			{{structName}} *self = ({{structName}} *)ty->tp_alloc(ty, 0);
+			if(!self) return 0;
+			{{structName}}_prepare(self);
 
 			try
 			{
-				new ((void *) &self->object) {{typeName}}(obj);
-				self->initialized = true;
+				{{construct}}
+				{{structName}}_track(self);
 				return (PyObject *)self;
 			}
 			catch(autobind::Exception &)
@@ -301,36 +481,247 @@ void Class::codegenDefinition(std::ostream &out) const
 				Py_XDECREF(self);
 				return PyErr_Format(PyExc_RuntimeError, "%s", exc.what());
 			}
+			catch(...)
+			{
+				Py_XDECREF(self);
+				PyErr_SetString(PyExc_RuntimeError, "unknown C++ exception");
+				return 0;
+			}
+		}
+	)EOF";
+
+	static const StringTemplate inlineConversionTemplate = R"EOF(
+		PyObject * autobind::Conversion<{{typeName}}>::dump(const {{typeName}} &obj) noexcept
+		{
+			return {{structName}}_create([&](void *address) {
+				::autobind::python::detail::copyConstruct(address, obj);
+			});
+		}
+
+		PyObject * autobind::Conversion<{{typeName}}>::dump({{typeName}} &&obj) noexcept
+		{
+			return {{structName}}_create([&](void *address) {
+				::autobind::python::detail::constructFrom(address, obj);
+			});
+		}
+
+		// Allocate a wrapper whose object is yet to be constructed, returning the 
+		// address at which to construct it, or null on failure.
+		void *autobind::Conversion<{{typeName}}>::allocate(PyObject **wrapper) noexcept
+		{
+			PyTypeObject *ty = &{{structName}}_Type;
+			
+			{{structName}} *self = ({{structName}} *)ty->tp_alloc(ty, 0);
+			*wrapper = (PyObject *) self;
+			if(!self) return 0;
+			{{structName}}_prepare(self);
+
+			self->object = &(({{structName}}_Inline *) self)->value;
+			return (void *) self->object;
+		}
+
+		// Mark the object of a wrapper from allocate() as constructed.
+		PyObject *autobind::Conversion<{{typeName}}>::finishConstruction(PyObject *wrapper) noexcept
+		{
+			{{structName}} *self = ({{structName}} *) wrapper;
+			self->initialized = true;
+			{{structName}}_track(self);
+			return wrapper;
+		}
+	)EOF";
+
+	// Copies of objects of classes with AB_HOLDER are made in new holders.
+	static const StringTemplate holderConversionTemplate = R"EOF(
+		PyObject * autobind::Conversion<{{typeName}}>::dump(const {{typeName}} &obj) noexcept
+		{
+			return {{structName}}_create([&] {
+				return ::autobind::python::detail::copyHeld<{{holderType}}<{{typeName}}> >(obj);
+			});
+		}
+
+		PyObject * autobind::Conversion<{{typeName}}>::dump({{typeName}} &&obj) noexcept
+		{
+			return {{structName}}_create([&] {
+				return ::autobind::python::detail::moveHeld<{{holderType}}<{{typeName}}> >(obj);
+			});
+		}
+
+		// Wrap an object owned by `holder`, taking over the ownership.
+		PyObject *autobind::Conversion<{{typeName}}>::adopt({{holderType}}<{{typeName}}> &&holder) noexcept
+		{
+			{{findHeld}}
+			PyTypeObject *ty = &{{structName}}_Type;
+
+			{{structName}} *self = ({{structName}} *)ty->tp_alloc(ty, 0);
+			if(!self) return 0;
+			{{structName}}_prepare(self);
+
+			self->object = holder.get();
+			self->holder.emplace(std::move(holder));
+			{{structName}}_track(self);
+			return (PyObject *) self;
+		}
+	)EOF";
+
+	static const StringTemplate conversionImplTemplate = R"EOF(
+		// Wrap an object that is owned elsewhere, without copying it. If `parent` isn't
+		// null, the wrapper keeps it alive, as the owner of the object.
+		PyObject *autobind::Conversion<{{typeName}}>::reference({{typeName}} &obj, PyObject *parent) noexcept
+		{
+			{{findReference}}
+			PyTypeObject *ty = &{{structName}}_Type;
+
+			{{allocate}}
+			if(!self) return 0;
+			{{structName}}_prepare(self);
+
+			{{markCompact}}
+			self->object = &obj;
+			Py_XINCREF(parent);
+			self->parent = parent;
+			{{structName}}_track(self);
+			return (PyObject *) self;
+		}
+
+		bool autobind::Conversion<{{typeName}}>::check(PyObject *obj) noexcept
+		{
+			return PyObject_TypeCheck(obj, &{{structName}}_Type);
+		}
+
+		bool autobind::Conversion<{{typeName}}>::tryLoad(PyObject *obj, 
+		                                                 autobind::Optional<{{typeName}} &> &result) noexcept
+		{
+			if(!check(obj)) return false;
+
+			{{structName}} *self = ({{structName}} *) obj;
+			if(!self->object) return false;
+
+			result.emplace(*self->object);
+			return true;
 		}
 
 		{{typeName}} &autobind::Conversion<{{typeName}}>::load(PyObject *obj)
 		{
-			int rv = PyObject_IsInstance(obj, (PyObject *) &{{structName}}_Type);
-			if(rv < 0)
+			autobind::Optional<{{typeName}} &> result;
+			if(!tryLoad(obj, result))
 			{
-				throw autobind::Exception();
+				throw std::runtime_error("Expected an instance of {{typeName}}.");
 			}
 
-			if(rv == 1)
+			return *result;
+		}
+	)EOF";
+
+
+	static const StringTemplate findReferenceTemplate = R"EOF(
+		if(PyObject *existing = {{structName}}_registry.find(&obj))
+		{
+			// a wrapper that owns nothing can still take on the parent
+			{{structName}} *self = ({{structName}} *) existing;
+			if(!self->{{owner}} && !self->parent && parent)
 			{
-				return (({{structName}} *) obj)->object;
+				Py_INCREF(parent);
+				self->parent = parent;
 			}
-			else
+
+			return existing;
+		}
+	)EOF";
+
+	static const StringTemplate findHeldTemplate = R"EOF(
+		if(PyObject *existing = {{structName}}_registry.find(holder.get()))
+		{
+			// a wrapper that owns nothing takes over the ownership
+			{{structName}} *self = ({{structName}} *) existing;
+			if(!self->holder)
 			{
-				throw std::runtime_error("Expected an instance of {{typeName}}.");
+				self->holder.emplace(std::move(holder));
 			}
+
+			return existing;
+		}
+	)EOF";
+
+	static const StringTemplate shareTemplate = R"EOF(
+		std::shared_ptr<{{typeName}}> autobind::Conversion<{{typeName}}>::share(PyObject *obj)
+		{
+			{{typeName}} &object = load(obj);
+
+			{{structName}} *self = ({{structName}} *) obj;
+			if(self->holder) return *self->holder;
+
+			// the object belongs to C++ code or to the wrapper's parent, so keep that alive
+			Py_INCREF(obj);
+			return std::shared_ptr<{{typeName}}>(&object, ::autobind::python::detail::ReleaseWithGIL{obj});
 		}
 	)EOF";
 
+	auto typeName = _decl.getQualifiedNameAsString();
+
+	createTemplate.into(out)
+		.set("structName", _selfTypeRef)
+		.setFunc("construct", [&](std::ostream &out) {
+			if(holderType.empty())
+			{
+				out << typeName << " *object = &((" << _selfTypeRef << "_Inline *) self)->value;\n"
+				    << "construct((void *) object);\n"
+				    << "self->object = object;\n"
+				    << "self->initialized = true;\n";
+				return;
+			}
+
+			out << "self->object = self->holder.emplace(construct()).get();\n";
+		})
+		.expand();
+
+	(holderType.empty()? inlineConversionTemplate : holderConversionTemplate).into(out)
+		.set("structName", _selfTypeRef)
+		.set("typeName", typeName)
+		.set("holderType", holderType)
+		.setFunc("findHeld", [&](std::ostream &out) {
+			if(!_classData.hasRegistry()) return;
+
+			findHeldTemplate.into(out)
+				.set("structName", _selfTypeRef)
+				.expand();
+		})
+		.expand();
 
 	conversionImplTemplate.into(out)
 		.set("structName", _selfTypeRef)
-		.set("moduleName", _moduleName)
-		.set("name", name())
-		.set("cppName", _decl.getQualifiedNameAsString())
-		.set("typeName", _decl.getQualifiedNameAsString())
+		.set("typeName", typeName)
+		.setFunc("findReference", [&](std::ostream &out) {
+			if(!_classData.hasRegistry()) return;
+
+			findReferenceTemplate.into(out)
+				.set("structName", _selfTypeRef)
+				.set("owner", holderType.empty()? "initialized" : "holder")
+				.expand();
+		})
+		.setFunc("allocate", [&](std::ostream &out) {
+			out << _selfTypeRef << " *self = (" << _selfTypeRef << " *)";
+			if(holderType.empty())
+			{
+				// the object is stored elsewhere, so the wrapper leaves out `value`
+				out << _selfTypeRef << "_Allocator::allocate(ty, sizeof(" << _selfTypeRef << "));\n";
+			}
+			else
+			{
+				out << "ty->tp_alloc(ty, 0);\n";
+			}
+		})
+		.setFunc("markCompact", [&](std::ostream &out) {
+			if(holderType.empty()) out << "self->compact = true;\n";
+		})
 		.expand();
 
+	if(holderType == "std::shared_ptr")
+	{
+		shareTemplate.into(out)
+			.set("structName", _selfTypeRef)
+			.set("typeName", typeName)
+			.expand();
+	}
 }
 
 
@@ -348,6 +739,10 @@ void Class::merge(const autobind::Export &other)
 void Class::codegenInit(std::ostream &out) const
 {
 	static const StringTemplate tpl = R"EOF(
+	#if PY_VERSION_HEX >= 0x03090000
+	{{selfTypeRef}}_Type.tp_vectorcall = {{vectorcallRef}};
+	#endif
+	{{allocator}}
 	if(PyType_Ready(&{{selfTypeRef}}_Type) < 0) return 0;
 	Py_INCREF(&{{selfTypeRef}}_Type);
 	PyModule_AddObject(mod, "{{name}}", (PyObject *) &{{selfTypeRef}}_Type);
@@ -355,6 +750,19 @@ void Class::codegenInit(std::ostream &out) const
 
 	tpl.into(out)
 		.set("selfTypeRef", _selfTypeRef)
+		.set("vectorcallRef", _vectorcallConstructor.implRef())
+		.setFunc("allocator", [&](std::ostream &out) {
+			if(_classData.freelistSize() > 0)
+			{
+				out << _selfTypeRef << "_Type.tp_alloc = " << _selfTypeRef << "_alloc;\n"
+				    << _selfTypeRef << "_Type.tp_free = " << _selfTypeRef << "_free;\n";
+			}
+			else
+			{
+				out << _selfTypeRef << "_Type.tp_alloc = " << _selfTypeRef << "_Allocator::alloc;\n"
+				    << _selfTypeRef << "_Type.tp_free = " << _selfTypeRef << "_Allocator::free;\n";
+			}
+		})
 		.set("name", name())
 		.expand();
 }
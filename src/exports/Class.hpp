@@ -32,6 +32,7 @@ class Class: public Export
 	ClassData _classData;
 
 	Constructor _constructor;
+	VectorcallConstructor _vectorcallConstructor;
 	std::map<std::string, std::unique_ptr<ClassExport>> _exports;
 	void mergeClassExport(std::unique_ptr<ClassExport>);
 public:
@@ -42,6 +43,8 @@ public:
 
 	void setModuleName(const std::string &moduleName) { _moduleName = moduleName; }
 
+	virtual void setModule(Module &) override;
+
 	virtual void codegenDeclaration(std::ostream &) const override;
 	virtual void codegenDefinition(std::ostream &) const override;
 	virtual void codegenMethodTable(std::ostream &) const override;
@@ -5,14 +5,20 @@
 
 #include <clang/AST/DeclCXX.h>
 
+#include <algorithm>
+#include <map>
+
 #include "Func.hpp"
 #include "../util.hpp"
 #include "../printing.hpp"
 #include "../CallGenerator.hpp"
+#include "../TupleUnpacker.hpp"
 #include "../StringTemplate.hpp"
 #include "../ClassData.hpp"
 #include "../diagnostics.hpp"
 #include "../DiscoveryVisitor.hpp"
+#include "../Module.hpp"
+#include "../attributeStream.hpp"
 
 namespace autobind {
 
@@ -38,9 +44,44 @@ void Func::merge(const autobind::Export &other)
 		Export::merge(other);
 	}
 }
+void Func::setModule(Module &module)
+{
+	_options = &module.options();
+}
+
+CallingConvention Func::callingConvention() const
+{
+	if(!options().fastcall)
+	{
+		return CallingConvention::VarargsKeywords;
+	}
+
+	auto allHaveArity = [&](unsigned arity) {
+		for(auto decl : _decls)
+		{
+			if(decl->getNumParams() != arity) return false;
+		}
+		return true;
+	};
+
+	if(allHaveArity(0))
+	{
+		return CallingConvention::NoArgs;
+	}
+	else if(allHaveArity(1))
+	{
+		return CallingConvention::SingleArg;
+	}
+	else
+	{
+		return CallingConvention::Fastcall;
+	}
+}
+
 void Func::codegenPrototype(std::ostream &out) const
 {
-	out << "PyObject *" << _implRef << "(" << _selfTypeRef << " *self, PyObject *args, PyObject *kwargs)";
+	out << "PyObject *" << _implRef << "(" << _selfTypeRef << " *self, " 
+		<< parameterList(callingConvention()) << ")";
 }
 
 void Func::codegenDeclaration(std::ostream &out) const
@@ -52,13 +93,116 @@ void Func::codegenDeclaration(std::ostream &out) const
 void Func::codegenOverload(std::ostream &out, size_t n) const
 {
 	auto &decl = decls().at(n);
-	const char *prefix = _selfTypeRef == "PyObject"? "" : "self->object.";
+	const char *prefix = _selfTypeRef == "PyObject"? "" : "self->object->";
 
-	CallGenerator cgen("args", "kwargs", decl, prefix);
+	CallGenerator cgen(callingConvention(), options(), decl, prefix);
 	cgen.codegen(out);
 }
 
 
+size_t Func::overloadCount() const
+{
+	return _decls.size();
+}
+
+
+std::vector<const clang::ParmVarDecl *> Func::overloadParams(size_t n) const
+{
+	auto decl = decls().at(n);
+	return {decl->param_begin(), decl->param_end()};
+}
+
+
+void Func::codegenDispatch(std::ostream &out) const
+{
+	// Alternatives are grouped by arity, since no other alternative can succeed; within 
+	// a group, each is guarded by a cheap check on keyword names and argument types
+	// so that its arguments are only unpacked if they could possibly be accepted.
+	// Declaration order is kept within a group, so the same alternative is chosen as 
+	// when trying each in turn.
+	//
+	// The guards depend only on the number of arguments, the keyword names, and the 
+	// types of the positional arguments, so the first alternative to pass them is cached
+	// by argument types; later calls with the same types jump straight to it. If it 
+	// fails, the search continues past it exactly as it would have without the cache.
+	std::map<size_t, std::vector<size_t>> byArity;
+	std::vector<std::string> labels;
+	size_t maxArity = 0;
+	for(size_t i = 0; i < overloadCount(); ++i)
+	{
+		auto arity = overloadParams(i).size();
+		byArity[arity].push_back(i);
+		maxArity = std::max(maxArity, arity);
+		labels.push_back(gensym("overload"));
+	}
+
+	TupleUnpacker counter(callingConvention(), options());
+	auto cacheSym = gensym("cache");
+	auto hintSym = gensym("hint");
+	auto cacheArgs = counter.positionalArrayExpr() + ", " + counter.positionalCountExpr() 
+		+ ", " + counter.keywordCountExpr();
+
+	if(maxArity > 0)
+	{
+		out << "static ::autobind::python::detail::OverloadCache<" << maxArity << "> " << cacheSym << ";\n"
+			<< "int " << hintSym << " = " << cacheSym << ".lookup(" << cacheArgs << ");\n"
+			<< "switch(" << hintSym << ")\n{\n";
+		for(size_t i = 0; i < labels.size(); ++i)
+		{
+			out << "case " << i << ": goto " << labels[i] << ";\n";
+		}
+		out << "}\n";
+	}
+
+	out << "switch(" << counter.positionalCountExpr() << " + " << counter.keywordCountExpr() << ")\n{\n";
+	for(const auto &group : byArity)
+	{
+		out << "case " << group.first << ":\n";
+		{
+			IndentingOStreambuf indenter(out, "\t");
+			for(auto i : group.second)
+			{
+				TupleUnpacker probe(callingConvention(), options());
+				for(auto param : overloadParams(i))
+				{
+					probe.addElement(*param);
+				}
+
+				out << "if(" << probe.viabilityCheck() << ")\n{\n";
+				{
+					IndentingOStreambuf indenter(out, "\t");
+					if(maxArity > 0)
+					{
+						out << "if(" << hintSym << " < 0)\n{\n"
+							<< "\t" << hintSym << " = " << i << ";\n"
+							<< "\t" << cacheSym << ".record(" << cacheArgs << ", " << i << ");\n"
+							<< "}\n"
+							<< labels[i] << ": ;\n";
+					}
+					// discard the error left by any alternative tried before
+					out << "PyErr_Clear();\n";
+					codegenOverload(out, i);
+				}
+				out << "}\n";
+			}
+			out << "break;\n";
+		}
+	}
+	out << "}\n";
+
+	static const StringTemplate noMatch = R"EOF(
+	if(!PyErr_Occurred())
+	{
+		PyErr_SetString(PyExc_TypeError, "no overload of {{name}}() accepts the given arguments");
+	}
+	)EOF";
+
+	noMatch.into(out)
+		.set("name", name())
+		.expand();
+}
+
+
 void Func::codegenDefinition(std::ostream &out) const
 {
 	codegenPrototype(out);
@@ -66,10 +210,18 @@ void Func::codegenDefinition(std::ostream &out) const
 	{
 		IndentingOStreambuf indenter(out, "\t");
 		beforeOverloads(out);
-		for(size_t i = 0; i < _decls.size(); ++i)
+		if(overloadCount() > 1)
 		{
-			codegenOverload(out, i);
+			codegenDispatch(out);
 		}
+		else
+		{
+			for(size_t i = 0; i < overloadCount(); ++i)
+			{
+				codegenOverload(out, i);
+			}
+		}
+		afterOverloads(out);
 		out << "return 0;\n";
 	}
 	out << "}\n";
@@ -103,7 +255,7 @@ void Func::codegenMethodTable(std::ostream &out) const
 {
 	out << "{"
 		<< "\"" << name() << "\", "
-		<< "(PyCFunction) &" << _implRef << ", METH_VARARGS | METH_KEYWORDS, "
+		<< "(PyCFunction) &" << _implRef << ", " << methodFlags(callingConvention()) << ", "
 		<< "\"" << docstringEscaped() << "\""
 		<< "},\n";
 }
@@ -116,14 +268,39 @@ Constructor::Constructor(const autobind::ClassData &classData)
 	setSelfTypeRef(classData.wrapperRef());
 }
 
+CallingConvention Constructor::callingConvention() const
+{
+	// tp_new always receives an argument tuple and keyword dict
+	return CallingConvention::VarargsKeywords;
+}
+
 void Constructor::codegenPrototype(std::ostream &out) const
 {
 	out << "PyObject *" << implRef() << "(PyTypeObject *ty, PyObject *args, PyObject *kwargs)";
 }
 
+size_t Constructor::overloadCount() const
+{
+	return decls().size() + (classData().isDefaultConstructible()? 1 : 0);
+}
+
+
+std::vector<const clang::ParmVarDecl *> Constructor::overloadParams(size_t n) const
+{
+	// the implicit default constructor, if any, is tried first
+	if(classData().isDefaultConstructible())
+	{
+		if(n == 0) return {};
+		--n;
+	}
+
+	return Func::overloadParams(n);
+}
+
+
 void Constructor::codegenOverload(std::ostream &out, size_t n) const
 {
-	codegenOverloadOrDefault(out, n);
+	codegenOverloadOrDefault(out, int(n) - (classData().isDefaultConstructible()? 1 : 0));
 }
 
 
@@ -136,12 +313,11 @@ void Constructor::codegenOverloadOrDefault(std::ostream &out, int n) const
 	try
 	{
 		PyErr_Clear();
-		self->initialized = false;
 		{{unpackTuple}}
 		if({{unpackOk}})
 		{
-			new((void *) &self->object) {{wrappedType}}({{callArgs}});
-			self->initialized = true;
+			{{construct}}
+			{{structName}}_track(self);
 			return (PyObject *)self;
 		}
 	}
@@ -157,7 +333,7 @@ void Constructor::codegenOverloadOrDefault(std::ostream &out, int n) const
 	}
 	)EOF";
 
-	TupleUnpacker unpacker("args", "kwargs");
+	TupleUnpacker unpacker(callingConvention(), options());
 	if(decl)
 	{
 		for(auto param : streams::stream(decl->param_begin(), decl->param_end()))
@@ -166,29 +342,127 @@ void Constructor::codegenOverloadOrDefault(std::ostream &out, int n) const
 		}
 	}
 
+	static const StringTemplate constructInline = R"EOF(
+	{{wrappedType}} *object = &(({{structName}}_Inline *) self)->value;
+	new((void *) object) {{wrappedType}}({{callArgs}});
+	self->object = object;
+	self->initialized = true;
+	)EOF";
+
+	static const StringTemplate constructHeld = R"EOF(
+	self->object = self->holder.emplace(
+		::autobind::python::detail::Holder<{{holderType}}<{{wrappedType}}> >::make({{callArgs}})
+	).get();
+	)EOF";
+
+	auto callArgs = streams::cat(streams::stream(unpacker.elementRefs()).interpose(", "));
+	auto &holderType = classData().holderType();
+
 	top.into(out)
 		.setFunc("unpackTuple", method(unpacker, &TupleUnpacker::codegen))
 		.set("unpackOk", unpacker.okRef())
-		.set("wrappedType", classData().typeRef())
-		.set("callArgs", streams::cat(streams::stream(unpacker.elementRefs()).interpose(", ")))
+		.set("structName", selfTypeRef())
+		.setFunc("construct", [&](std::ostream &out) {
+			(holderType.empty()? constructInline : constructHeld).into(out)
+				.set("structName", selfTypeRef())
+				.set("wrappedType", classData().typeRef())
+				.set("holderType", holderType)
+				.set("callArgs", callArgs)
+				.expand();
+		})
 		.expand();
 }
 
+void Constructor::codegenNotConstructible(std::ostream &out) const
+{
+	out << "PyErr_SetString(PyExc_TypeError, \"" << classData().exportName() 
+	    << " cannot be constructed from Python\");\n";
+}
+
 void Constructor::beforeOverloads(std::ostream &out) const
 {
+	// such as abstract classes, which can still be returned through a holder
+	if(overloadCount() == 0)
+	{
+		codegenNotConstructible(out);
+		return;
+	}
+
 	static const StringTemplate allocSelf = R"EOF(
 	{{structName}} *self = ({{structName}} *) ty->tp_alloc(ty, 0);
 	if(!self) return 0;
+	{{structName}}_prepare(self);
 	)EOF";
 
 	allocSelf.into(out)
 		.set("structName", selfTypeRef())
 		.expand();
+}
 
-	if(classData().isDefaultConstructible())
+void Constructor::afterOverloads(std::ostream &out) const
+{
+	if(overloadCount() > 0) out << "Py_DECREF(self);\n";
+}
+
+VectorcallConstructor::VectorcallConstructor(const ClassData &classData,
+                                             const Constructor &slotConstructor)
+: Export(classData.exportName())
+, Constructor(classData)
+, _newRef(slotConstructor.implRef())
+{
+}
+
+CallingConvention VectorcallConstructor::callingConvention() const
+{
+	return CallingConvention::Fastcall;
+}
+
+void VectorcallConstructor::codegenPrototype(std::ostream &out) const
+{
+	out << "PyObject *" << implRef() 
+		<< "(PyObject *callable, PyObject *const *args, size_t nargsf, PyObject *kwnames)";
+}
+
+void VectorcallConstructor::codegenDefinition(std::ostream &out) const
+{
+	// tp_vectorcall only exists as of Python 3.9
+	out << "#if PY_VERSION_HEX >= 0x03090000\n";
+	Constructor::codegenDefinition(out);
+	out << "#endif\n";
+}
+
+void VectorcallConstructor::beforeOverloads(std::ostream &out) const
+{
+	static const StringTemplate redirect = R"EOF(
+	PyTypeObject *ty = (PyTypeObject *) callable;
+	Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+
+	if(ty->tp_new != {{newRef}} || ty->tp_init != (initproc) {{structName}}_init)
+	{
+		return ::autobind::python::detail::callTypeSlots(ty, args, nargs, kwnames);
+	}
+	)EOF";
+
+	static const StringTemplate allocSelf = R"EOF(
+	{{structName}} *self = ({{structName}} *) ty->tp_alloc(ty, 0);
+	if(!self) return 0;
+	{{structName}}_prepare(self);
+	)EOF";
+
+	redirect.into(out)
+		.set("structName", selfTypeRef())
+		.set("newRef", _newRef)
+		.expand();
+
+	if(overloadCount() == 0)
 	{
-		codegenOverloadOrDefault(out, -1);
+		codegenNotConstructible(out);
+		return;
 	}
+
+	allocSelf.into(out)
+		.set("structName", selfTypeRef())
+		.expand();
 }
 
 bool Func::validate(const autobind::ConversionInfo &info) const
@@ -200,6 +474,7 @@ bool Func::validate(const autobind::ConversionInfo &info) const
 		for(auto param : stream(func->param_begin(),
 		                        func->param_end()))
 		{
+			if(TupleUnpacker::isUnpackedDirectly(*param)) continue;
 			result = info.ensureConversionSpecializationExists(param, param->getType().getTypePtr()) && result;
 		}
 
@@ -293,7 +568,7 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 		{
 			try
 			{
-				PyObject *result = ::autobind::Conversion<{{type}}>::dump(self->object.{{func}}());
+				PyObject *result = ::autobind::Conversion<{{type}}>::dump(self->object->{{func}}());
 				PyErr_Clear();
 				return result;
 			}
@@ -309,6 +584,13 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 		}
 		)EOF";
 
+		static const StringTemplate leanTpl = R"EOF(
+		static PyObject *{{implName}}({{selfTypeName}} *self, void */*closure*/)
+		{
+			return ::autobind::Conversion<{{type}}>::dump(self->object->{{func}}());
+		}
+		)EOF";
+
 		if(_getter->param_size() != 0)
 			diag::stop(**_getter->param_begin(), "getter must have no parameters");
 
@@ -320,7 +602,10 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 		ty.removeLocalRestrict();
 		ty.removeLocalVolatile();
 
-		tpl.into(out)
+		bool nothrow = isNothrow(*_getter) 
+			&& isNothrowConversion(_getter->getASTContext(), ty, "dump");
+
+		(nothrow? leanTpl : tpl).into(out)
 			.set("implName", _getterRef)
 			.set("selfTypeName", classData().wrapperRef())
 			.set("type", ty.getCanonicalType().getAsString())
@@ -341,7 +626,7 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 
 			try
 			{
-				self->object.{{func}}(::autobind::Conversion<{{type}}>::load(value));
+				self->object->{{func}}(::autobind::Conversion<{{type}}>::load(value));
 				PyErr_Clear();
 				return 0;
 			}
@@ -357,6 +642,30 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 		}
 		)EOF";
 
+		static const StringTemplate leanTpl = R"EOF(
+		static int {{implName}}({{selfTypeName}} *self, PyObject *value, void *closure)
+		{
+			if(!value)
+			{
+				PyErr_SetString(PyExc_TypeError, "Cannot delete attribute.");
+				return -1;
+			}
+
+			::autobind::Optional< {{type}} > loaded;
+			if(!::autobind::Conversion<{{type}}>::tryLoad(value, loaded))
+			{
+				if(!PyErr_Occurred())
+				{
+					PyErr_SetString(PyExc_TypeError, "Expected a value convertible to {{type}}.");
+				}
+				return -1;
+			}
+
+			self->object->{{func}}(*loaded);
+			return 0;
+		}
+		)EOF";
+
 		if(_setter->param_size() != 1)
 			diag::stop(*_setter, "setter must have exactly one parameter");
 
@@ -365,7 +674,12 @@ void Descriptor::codegenDefinition(std::ostream &out) const
 		ty.removeLocalRestrict();
 		ty.removeLocalVolatile();
 
-		tpl.into(out)
+		// Only scalars are handled without exceptions, since their copies cannot throw.
+		bool nothrow = isNothrow(*_setter)
+			&& ty->isScalarType()
+			&& isNothrowConversion(_setter->getASTContext(), ty, "tryLoad");
+
+		(nothrow? leanTpl : tpl).into(out)
 			.set("implName", _setterRef)
 			.set("selfTypeName", classData().wrapperRef())
 			.set("type", ty.getCanonicalType().getAsString())
@@ -451,13 +765,32 @@ void Field::codegenDefinition(std::ostream &out) const
 	fieldTy.removeLocalRestrict();
 	fieldTy.removeLocalVolatile();
 
+	if(isView())
+	{
+		// The memoryview keeps the wrapper alive, and is read-only if the field is const.
+		static const StringTemplate viewTpl = R"EOF(
+		static PyObject *{{implName}}({{selfTypeName}} *self, void */*closure*/)
+		{
+			return ::autobind::python::detail::fieldView((PyObject *) self, self->object->{{field}}, {{readonly}});
+		}
+		)EOF";
+
+		viewTpl.into(out)
+			.set("implName", _getterRef)
+			.set("selfTypeName", classData().wrapperRef())
+			.set("field", _field->getNameAsString())
+			.set("readonly", _field->getType().isConstQualified()? "true" : "false")
+			.expand();
+		return;
+	}
+
 	// getter
 	static const StringTemplate tpl = R"EOF(		
 	static PyObject *{{implName}}({{selfTypeName}} *self, void */*closure*/)
 	{
 		try
 		{
-			PyObject *result = ::autobind::Conversion<{{type}}>::dump(self->object.{{field}});
+			PyObject *result = ::autobind::Conversion<{{type}}>::dump(self->object->{{field}});
 			PyErr_Clear();
 			return result;
 		}
@@ -474,7 +807,16 @@ void Field::codegenDefinition(std::ostream &out) const
 	)EOF";
 
 
-	tpl.into(out)
+	static const StringTemplate leanTpl = R"EOF(
+	static PyObject *{{implName}}({{selfTypeName}} *self, void */*closure*/)
+	{
+		return ::autobind::Conversion<{{type}}>::dump(self->object->{{field}});
+	}
+	)EOF";
+
+	auto &ctx = _field->getASTContext();
+
+	(isNothrowConversion(ctx, fieldTy, "dump")? leanTpl : tpl).into(out)
 		.set("implName", _getterRef)
 		.set("selfTypeName", classData().wrapperRef())
 		.set("type", fieldTy.getCanonicalType().getAsString())
@@ -494,7 +836,7 @@ void Field::codegenDefinition(std::ostream &out) const
 
 			try
 			{
-				self->object.{{field}} = ::autobind::Conversion<{{type}}>::load(value);
+				self->object->{{field}} = ::autobind::Conversion<{{type}}>::load(value);
 				PyErr_Clear();
 				return 0;
 			}
@@ -510,7 +852,34 @@ void Field::codegenDefinition(std::ostream &out) const
 		}
 		)EOF";
 
-		tpl.into(out)
+		static const StringTemplate leanTpl = R"EOF(
+		static int {{implName}}({{selfTypeName}} *self, PyObject *value, void *closure)
+		{
+			if(!value)
+			{
+				PyErr_SetString(PyExc_TypeError, "Cannot delete attribute.");
+				return -1;
+			}
+
+			::autobind::Optional< {{type}} > loaded;
+			if(!::autobind::Conversion<{{type}}>::tryLoad(value, loaded))
+			{
+				if(!PyErr_Occurred())
+				{
+					PyErr_SetString(PyExc_TypeError, "Expected a value convertible to {{type}}.");
+				}
+				return -1;
+			}
+
+			self->object->{{field}} = *loaded;
+			return 0;
+		}
+		)EOF";
+
+		// Only scalars are assigned without exceptions, since their copies cannot throw.
+		bool nothrow = fieldTy->isScalarType() && isNothrowConversion(ctx, fieldTy, "tryLoad");
+
+		(nothrow? leanTpl : tpl).into(out)
 			.set("implName", _setterRef)
 			.set("selfTypeName", classData().wrapperRef())
 			.set("type", fieldTy.getCanonicalType().getAsString())
@@ -521,7 +890,14 @@ void Field::codegenDefinition(std::ostream &out) const
 
 bool Field::isWritable() const
 {
-	return !_field->getType().isConstQualified();
+	// views are modified in place rather than assigned
+	return !_field->getType().isConstQualified() && !isView();
+}
+
+
+bool Field::isView() const
+{
+	return isPyView(_field);
 }
 
 
@@ -546,6 +922,23 @@ void Field::codegenGetSet(std::ostream &out) const
 
 bool Field::validate(const autobind::ConversionInfo &convInfo) const
 {
+	if(isView())
+	{
+		// A view captures the address of the elements, which resizing a vector would 
+		// invalidate. detail::fieldView() rejects the other types that can't be viewed.
+		auto ty = _field->getType();
+		auto record = ty->getAsCXXRecordDecl();
+		if(!ty.isConstQualified() && record && record->isInStdNamespace() 
+		   && record->getName() == "vector")
+		{
+			diag::emit(clang::DiagnosticsEngine::Error, *_field, 
+			           "a viewed std::vector must be const, as resizing it would invalidate its views");
+			return false;
+		}
+
+		return true;
+	}
+
 	return convInfo.ensureConversionSpecializationExists(_field,
 	                                                     _field->getType().getTypePtr());
 }
@@ -10,6 +10,8 @@
 #include <clang/AST/Decl.h>
 
 #include "../Export.hpp"
+#include "../CallingConvention.hpp"
+#include "../CodegenOptions.hpp"
 #include "ClassExport.hpp"
 
 namespace autobind {
@@ -19,10 +21,22 @@ class Func: public virtual Export
 	std::vector<const clang::FunctionDecl *> _decls;
 	std::string _implRef;
 	std::string _selfTypeRef;
+	const CodegenOptions *_options = nullptr;
+
+	void codegenDispatch(std::ostream &) const;
 protected:
+	/// The calling convention used by the generated wrapper.
+	virtual CallingConvention callingConvention() const;
 	virtual void codegenPrototype(std::ostream &) const;
 	virtual void codegenOverload(std::ostream &, size_t) const;
 	virtual void beforeOverloads(std::ostream &) const { }
+	virtual void afterOverloads(std::ostream &) const { }
+
+	/// The number of alternatives the generated wrapper may try.
+	virtual size_t overloadCount() const;
+
+	/// The parameters of the nth alternative.
+	virtual std::vector<const clang::ParmVarDecl *> overloadParams(size_t) const;
 public:
 	Func(std::string name);
 
@@ -54,6 +68,13 @@ public:
 	{
 		return _implRef;
 	}
+
+	const CodegenOptions &options() const
+	{
+		return _options? *_options : CodegenOptions::defaults();
+	}
+
+	virtual void setModule(Module &) override;
 	
 	virtual void merge(const Export &e) override;
 	virtual bool validate(const ConversionInfo &) const;
@@ -72,9 +93,34 @@ public:
 	Constructor(const ClassData &classData);
 
 protected:
-	virtual void codegenPrototype(std::ostream &) const;
-	virtual void codegenOverload(std::ostream &, size_t) const;
-	virtual void beforeOverloads(std::ostream &) const;
+	virtual CallingConvention callingConvention() const override;
+	virtual void codegenPrototype(std::ostream &) const override;
+	virtual void codegenOverload(std::ostream &, size_t) const override;
+	virtual void beforeOverloads(std::ostream &) const override;
+	virtual void afterOverloads(std::ostream &) const override;
+	virtual size_t overloadCount() const override;
+	virtual std::vector<const clang::ParmVarDecl *> overloadParams(size_t) const override;
+
+	/// Raise TypeError, for classes without constructors that Python can call.
+	void codegenNotConstructible(std::ostream &) const;
+};
+
+
+/// The tp_vectorcall of a generated type, which takes its arguments as an array
+/// rather than a tuple and dict, and constructs the object without calling tp_init.
+/// Calls on subclasses that replace tp_new or tp_init fall back to both slots.
+class VectorcallConstructor: public Constructor
+{
+	std::string _newRef;
+public:
+	VectorcallConstructor(const ClassData &classData, const Constructor &slotConstructor);
+
+	virtual void codegenDefinition(std::ostream &) const override;
+
+protected:
+	virtual CallingConvention callingConvention() const override;
+	virtual void codegenPrototype(std::ostream &) const override;
+	virtual void beforeOverloads(std::ostream &) const override;
 };
 
 
@@ -111,6 +157,9 @@ public:
 
 	bool isWritable() const;
 
+	/// Whether the field is read as a memoryview of its storage (see AB_VIEW).
+	bool isView() const;
+
 	virtual void codegenDeclaration(std::ostream &) const override;
 	virtual void codegenDefinition(std::ostream &) const override;
 	virtual void codegenMethodTable(std::ostream &) const override;
@@ -6,8 +6,12 @@
 #include <boost/algorithm/string.hpp>
 #include <unordered_map>
 #include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/DeclTemplate.h>
 #include <clang/AST/ASTContext.h>
+#include <array>
 #include "util.hpp"
+#include "attributeStream.hpp"
 #include "stream.hpp"
 #include "regex.hpp"
 #include "printing.hpp"
@@ -180,6 +184,60 @@ std::string processDocString(const std::string &docstring)
 }
 
 
-} // autobind
+bool isNothrow(const clang::FunctionDecl &decl)
+{
+	auto proto = decl.getType()->getAs<clang::FunctionProtoType>();
+	return proto && proto->isNothrow(decl.getASTContext());
+}
 
+static clang::ClassTemplateDecl *findConversionTemplate(clang::ASTContext &ctx)
+{
+	const clang::DeclContext *dc = ctx.getTranslationUnitDecl();
+	for(auto name : {"autobind", "python"})
+	{
+		auto result = dc->lookup(&ctx.Idents.get(name));
+		if(result.empty()) return nullptr;
+
+		dc = llvm::dyn_cast<clang::NamespaceDecl>(result.front());
+		if(!dc) return nullptr;
+	}
 
+	auto result = dc->lookup(&ctx.Idents.get("Conversion"));
+	return result.empty()? nullptr : llvm::dyn_cast<clang::ClassTemplateDecl>(result.front());
+}
+
+bool isNothrowConversion(clang::ASTContext &ctx, clang::QualType ty, const std::string &member)
+{
+	ty = ty.getNonReferenceType().getCanonicalType().getUnqualifiedType();
+
+	if(auto record = ty->getAsCXXRecordDecl())
+	{
+		if(isPyExport(record)) return true;
+	}
+
+	auto conversion = findConversionTemplate(ctx);
+	if(!conversion) return false;
+
+	std::array<clang::TemplateArgument, 2> args {{
+		clang::TemplateArgument(ty),
+		clang::TemplateArgument(ctx.VoidTy)
+	}};
+
+	void *insertPos = 0;
+	auto spec = conversion->findSpecialization(llvm::makeArrayRef(args.data(), args.size()), insertPos);
+	if(!spec) return false;
+
+	bool found = false;
+	for(auto method : PROP_RANGE(spec->method))
+	{
+		if(method->getNameAsString() == member)
+		{
+			found = true;
+			if(!isNothrow(*method)) return false;
+		}
+	}
+
+	return found;
+}
+
+} // autobind
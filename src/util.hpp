@@ -90,6 +90,15 @@ IterRange<T> toRange(T first, T last)
 std::string findDocumentationComments(const clang::Decl &d);
 std::string createPythonSignature(const clang::FunctionDecl &d);
 
+/// Determine whether `decl` has a non-throwing exception specification.
+bool isNothrow(const clang::FunctionDecl &decl);
+
+/// Determine whether the member functions named `member` of `autobind::Conversion<ty>`
+/// are all declared noexcept. This is false if no explicit specialization declaring
+/// them can be found, except for exported classes, whose generated `dump()`, 
+/// `tryLoad()` and `check()` never throw.
+bool isNothrowConversion(clang::ASTContext &ctx, clang::QualType ty, const std::string &member);
+
 template <class K, class V>
 boost::optional<const V &> get(const std::map<K, V> &map,
                                const K &key)
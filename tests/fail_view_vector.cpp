@@ -0,0 +1,17 @@
+// Expected
+// ========
+//
+// …/tests/fail_view_vector.cpp:16:37: error: a viewed std::vector must be const, as resizing it would invalidate its views
+//         std::vector<float> pyexport pyview samples;
+//                                            ^
+// 1 error generated.
+
+#include <autobind.hpp>
+#include <vector>
+
+pymodule(fail_view_vector);
+
+struct pyexport C
+{
+	std::vector<float> pyexport pyview samples;
+};
@@ -0,0 +1,26 @@
+// This file should compile successfully.
+
+#include <autobind.hpp>
+
+pymodule(fastcall);
+pycodegen(fastcall);
+
+
+pyexport int no_args() { return 42; }
+pyexport int one_arg(int x) { return x + 1; }
+pyexport std::string two_args(int x, const std::string &y) { return std::to_string(x) + y; }
+
+pyexport std::string overload(int) { return "int"; }
+pyexport std::string overload(int, int) { return "int, int"; }
+
+struct pyexport Counter
+{
+	int count;
+
+	Counter(int count)
+	: count(count) { }
+
+	int get() const { return count; }
+	int add(int n) { return count += n; }
+	int add_scaled(int n, int scale) { return count += n * scale; }
+};
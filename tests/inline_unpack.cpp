@@ -0,0 +1,29 @@
+// This file should compile successfully.
+
+#include <autobind.hpp>
+
+pymodule(inline_unpack);
+pycodegen(inline_unpack);
+
+
+pyexport std::string describe(int number, const char *text, const std::string &other)
+{
+	return std::to_string(number) + text + other;
+}
+
+pyexport int no_args() { return 42; }
+
+pyexport std::string describe_scalars(double real, bool flag, long long wide, unsigned char narrow)
+{
+	return std::to_string(int(real * 2)) + (flag? "y" : "n") + std::to_string(wide) + std::to_string(narrow);
+}
+
+struct pyexport Pair
+{
+	int first, second;
+
+	Pair(int first, int second)
+	: first(first), second(second) { }
+
+	int sum() const { return first + second; }
+};
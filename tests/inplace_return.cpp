@@ -0,0 +1,35 @@
+// This file should compile successfully.
+
+#include <autobind.hpp>
+#include <memory>
+
+pymodule(inplace_return);
+pycodegen(inplace_return);
+
+
+struct pyexport Token
+{
+	std::unique_ptr<int> value;
+
+	Token(int value)
+	: value(new int(value)) { }
+
+	int get() const { return *value; }
+};
+
+struct pyexport Point
+{
+	int pyexport x, y;
+
+	Point(int x, int y)
+	: x(x), y(y) { }
+};
+
+pyexport Token make_token(int value) { return Token(value); }
+pyexport Point make_point(int x, int y) { return Point(x, y); }
+
+pyexport Point make_point_or_throw(int x, int y)
+{
+	if(x < 0) throw std::runtime_error("negative");
+	return Point(x, y);
+}
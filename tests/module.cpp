@@ -1,6 +1,9 @@
 // This file should compile successfully.
 
 #include <autobind.hpp>
+#include <array>
+#include <cstdint>
+#include <numeric>
 
 pymodule(module);
 
@@ -38,6 +41,109 @@ struct pyexport Accessors
 };
 
 
+struct pyexport NothrowAccessors
+{
+	int _value = 0;
+
+	pygetter(value) int value() const noexcept { return _value; }
+	pysetter(value) void set_value(int v) noexcept { _value = v; }
+};
+
+
+pyexport std::vector<Accessors> make_accessors(int n)
+{
+	std::vector<Accessors> result;
+	for(int i = 0; i < n; ++i)
+	{
+		result.emplace_back(i);
+	}
+
+	return result;
+}
+
+
+struct pyexport Holder
+{
+	Accessors inner { 7 };
+
+	pyreturn(reference_internal) Accessors &get() { return inner; }
+	Accessors &copy() { return inner; }
+	int value() const { return inner.foo; }
+};
+
+
+struct pyexport pyidentity Node
+{
+	Node *successor = nullptr;
+
+	void link(Node &n) { successor = &n; }
+	pyreturn(reference) Node &next() { return *successor; }
+};
+
+
+struct pyexport pyholder(shared_ptr) Shared
+{
+	int pyexport value = 0;
+};
+
+static std::shared_ptr<Shared> keptShared;
+
+pyexport void keep_shared(std::shared_ptr<Shared> p) { keptShared = p; }
+pyexport std::shared_ptr<Shared> kept_shared() { return keptShared; }
+
+
+struct pyexport pyfreelist(4) pyholder(shared_ptr) PooledShared
+{
+	int pyexport value = 0;
+};
+
+pyexport std::shared_ptr<PooledShared> make_pooled_shared(int value)
+{
+	auto result = std::make_shared<PooledShared>();
+	result->value = value;
+	return result;
+}
+
+
+struct pyexport pyholder(unique_ptr) Resource
+{
+	int id;
+
+	Resource(int id)
+	: id(id) { }
+	Resource(const Resource &) = delete;
+};
+
+pyexport std::unique_ptr<Resource> open_resource(int id) { return std::unique_ptr<Resource>(new Resource(id)); }
+pyexport int resource_id(const Resource &r) { return r.id; }
+
+
+struct pyexport pyholder(shared_ptr) Shape
+{
+	virtual ~Shape() { }
+	virtual double area() const = 0;
+};
+
+struct Square: Shape
+{
+	double side;
+
+	Square(double side)
+	: side(side) { }
+
+	double area() const override { return side * side; }
+};
+
+pyexport std::shared_ptr<Shape> make_square(double side) { return std::make_shared<Square>(side); }
+pyexport double shape_area(std::shared_ptr<const Shape> shape) { return shape->area(); }
+pyexport std::shared_ptr<const Shared> const_shared(int value)
+{
+	auto result = std::make_shared<Shared>();
+	result->value = value;
+	return result;
+}
+
+
 struct pyexport Methods
 {
 	std::string s;
@@ -106,6 +212,72 @@ struct pyexport ThrowCheck
 	}
 };
 
+struct pyexport pyfreelist(4) PooledAllocCheck
+{
+	AllocCheck ac;
+	int value;
+
+	PooledAllocCheck(int value): value(value) { }
+
+	int get() const { return value; }
+};
+
+struct pyexport OverAligned
+{
+	alignas(64) int values[16];
+
+	OverAligned(int value)
+	{
+		std::fill(values, values + 16, value);
+	}
+
+	int sum() const { return std::accumulate(values, values + 16, 0); }
+	int is_aligned() const { return reinterpret_cast<std::uintptr_t>(values) % 64 == 0; }
+};
+
+struct pyexport Samples
+{
+	std::vector<double> values;
+
+	Samples(int n): values(n)
+	{
+		std::iota(values.begin(), values.end(), 0.5);
+	}
+
+	AB_NOEXPORT double *data() { return values.data(); }
+	std::size_t size() const { return values.size(); }
+	double total() const { return std::accumulate(values.begin(), values.end(), 0.0); }
+};
+
+struct pyexport FrozenSamples
+{
+	std::vector<short> values { 1, -2 };
+
+	AB_NOEXPORT const short *data() const { return values.data(); }
+	std::size_t size() const { return values.size(); }
+};
+
+struct pyexport Signal
+{
+	std::array<float, 3> pyexport pyview samples {{ 1, 2, 3 }};
+	const std::vector<short> pyexport pyview limits { -1, 1 };
+	double pyexport pyview gains[2] = { 0.5, 2 };
+
+	float total() const { return std::accumulate(samples.begin(), samples.end(), 0.0f) * gains[1]; }
+};
+
+/// A 2x3 matrix whose rows are padded to 4 elements.
+struct pyexport PaddedMatrix
+{
+	float values[2][4] = {{0, 1, 2, -1}, {10, 11, 12, -1}};
+
+	AB_NOEXPORT float *data() { return &values[0][0]; }
+	std::size_t size() const { return 6; }
+	AB_NOEXPORT std::vector<std::size_t> shape() const { return {2, 3}; }
+	AB_NOEXPORT std::vector<std::size_t> strides() const { return {sizeof(values[0]), sizeof(float)}; }
+	float at(int row, int col) const { return values[row][col]; }
+};
+
 struct pyexport ConstructorOverload
 {
 	int argCount;
@@ -142,6 +314,48 @@ pyexport std::string overload(int) { return "int"; }
 pyexport std::string overload(const std::string &) { return "std::string"; }
 pyexport std::string overload(int, int) { return "int, int"; }
 
+pyexport int add_nothrow(int a, int b) noexcept { return a + b; }
+
+pyexport std::string scalar_overload(double) { return "double"; }
+pyexport std::string scalar_overload(const std::string &) { return "std::string"; }
+pyexport std::string scalar_overload(unsigned short, bool) { return "unsigned short, bool"; }
+
+pyexport double half(double x) noexcept { return x / 2; }
+pyexport unsigned long long successor(unsigned long long x) { return x + 1; }
+pyexport bool negated(bool x) { return !x; }
+pyexport std::vector<short> shorts(const std::vector<short> &values) { return values; }
+pyexport std::vector<float> floats(const std::vector<float> &values) { return values; }
+pyexport double span_total(autobind::Span<const double> values) { return std::accumulate(values.begin(), values.end(), 0.0); }
+pyexport void span_negate(autobind::Span<int> values) { for(auto &v : values) v = -v; }
+pyexport autobind::StringRef echo_ref(autobind::StringRef s) { return s; }
+pyexport bool is_key(autobind::StringRef s) { return s == "key"; }
+
+pyexport std::string named_overload(int a) { return "a"; }
+pyexport std::string named_overload(const std::string &b) { return "b"; }
+
+
+pyexport long iterated_sum(autobind::ObjectRef items)
+{
+	long total = 0;
+	autobind::IteratorRef it(*items.get());
+	autobind::ObjectRef item;
+	while(it.next(item))
+	{
+		total += item.convert<long>();
+	}
+
+	return total;
+}
+
+pyexport autobind::ObjectRef call_with(autobind::ObjectRef callback, int a, int b)
+{
+	return callback(a, autobind::keyword("b", b));
+}
+
+pyexport autobind::ObjectRef call_method(autobind::ObjectRef obj, const std::string &name, int a)
+{
+	return obj.callMethod(name.c_str(), a);
+}
 
 pyexport autobind::Optional<std::string> get_exception_message(autobind::ObjectRef callback)
 {
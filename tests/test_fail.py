@@ -50,3 +50,9 @@ def test_fail_no_conversion2():
 	check_errors(file, expected)
 
 
+
+def test_fail_view_vector():
+	file = os.path.abspath('fail_view_vector.cpp')
+	expected = [dict(filename=file, message='a viewed std::vector must be const, as resizing it would invalidate its views',
+	                 line=16, col=37)]
+	check_errors(file, expected)
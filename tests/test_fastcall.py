@@ -0,0 +1,36 @@
+
+import fastcall
+import pytest
+
+def test_no_args():
+	assert fastcall.no_args() == 42
+	with pytest.raises(TypeError):
+		fastcall.no_args(1)
+
+def test_one_arg():
+	assert fastcall.one_arg(1) == 2
+	with pytest.raises(TypeError):
+		fastcall.one_arg()
+
+def test_two_args():
+	assert fastcall.two_args(1, 'a') == '1a'
+	assert fastcall.two_args(1, y='a') == '1a'
+	assert fastcall.two_args(y='a', x=1) == '1a'
+
+def test_bad_keywords():
+	with pytest.raises(TypeError):
+		fastcall.two_args(1, x=1)
+	with pytest.raises(TypeError):
+		fastcall.two_args(1, z='a')
+	with pytest.raises(TypeError):
+		fastcall.two_args(1)
+
+def test_overload():
+	assert fastcall.overload(1) == 'int'
+	assert fastcall.overload(1, 2) == 'int, int'
+
+def test_methods():
+	c = fastcall.Counter(1)
+	assert c.get() == 1
+	assert c.add(2) == 3
+	assert c.add_scaled(n=1, scale=10) == 13
@@ -0,0 +1,48 @@
+
+import inline_unpack
+import pytest
+
+def test_positional():
+	assert inline_unpack.describe(1, 'a', 'b') == '1ab'
+
+def test_keywords():
+	assert inline_unpack.describe(1, other='b', text='a') == '1ab'
+	assert inline_unpack.describe(**{'number': 1, 'text': 'a', 'other': 'b'}) == '1ab'
+
+def test_subclasses():
+	class MyInt(int): pass
+	class MyStr(str): pass
+	assert inline_unpack.describe(MyInt(1), MyStr('a'), 'b') == '1ab'
+
+def test_errors():
+	with pytest.raises(TypeError):
+		inline_unpack.describe(1, 'a')
+	with pytest.raises(TypeError):
+		inline_unpack.describe(1, 'a', 'b', 'c')
+	with pytest.raises(TypeError):
+		inline_unpack.describe(1, 'a', 'b', number=1)
+	with pytest.raises(TypeError):
+		inline_unpack.describe(1, 'a', bogus='b')
+	with pytest.raises(TypeError):
+		inline_unpack.describe(1.0, 'a', 'b')
+	with pytest.raises(OverflowError):
+		inline_unpack.describe(2**40, 'a', 'b')
+	with pytest.raises(TypeError):
+		inline_unpack.no_args(1)
+
+def test_scalars():
+	assert inline_unpack.describe_scalars(1.5, True, 2**40, 255) == '3y1099511627776255'
+	assert inline_unpack.describe_scalars(2, [], wide=-1, narrow=0) == '4n-10'
+	with pytest.raises(OverflowError):
+		inline_unpack.describe_scalars(0.0, True, 2**63, 0)
+	with pytest.raises(OverflowError):
+		inline_unpack.describe_scalars(0.0, True, 0, 256)
+	with pytest.raises(OverflowError):
+		inline_unpack.describe_scalars(0.0, True, 0, -1)
+	with pytest.raises(TypeError):
+		inline_unpack.describe_scalars(0.0, True, 1.0, 0)
+	with pytest.raises(TypeError):
+		inline_unpack.describe_scalars('0', True, 0, 0)
+
+def test_constructor():
+	assert inline_unpack.Pair(1, second=2).sum() == 3
@@ -0,0 +1,14 @@
+import inplace_return
+import pytest
+
+def test_noncopyable():
+	assert inplace_return.make_token(5).get() == 5
+
+def test_copyable():
+	p = inplace_return.make_point(1, 2)
+	assert (p.x, p.y) == (1, 2)
+
+def test_exception():
+	with pytest.raises(RuntimeError):
+		inplace_return.make_point_or_throw(-1, 0)
+	assert inplace_return.make_point_or_throw(1, 0).x == 1
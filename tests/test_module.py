@@ -1,6 +1,10 @@
 
+import array
+import gc
 import module
 import pytest
+import sys
+import sysconfig
 
 def test_constructor():
 	# TODO: constructor docstrings
@@ -67,6 +71,119 @@ def test_throw_alloc():
 	assert module.alloc_count() == module.dealloc_count() and module.alloc_count() == 100
 
 
+def test_freelist_allocs():
+	module.reset_allocs()
+	for i in range(3):
+		pooled = [module.PooledAllocCheck(j) for j in range(10)]
+		assert [p.get() for p in pooled] == list(range(10))
+		del pooled
+
+	assert module.alloc_count() == module.dealloc_count() and module.alloc_count() == 30
+
+	class Sub(module.PooledAllocCheck):
+		pass
+
+	assert Sub(5).get() == 5
+
+
+@pytest.mark.skipif(sysconfig.get_config_var('Py_GIL_DISABLED'), 
+                    reason='freelists keep nothing in free-threaded builds')
+def test_freelist_reuse():
+	# empty the freelist, so that the wrappers freed below are kept in it
+	held = [module.PooledAllocCheck(0) for i in range(8)]
+
+	p = module.PooledAllocCheck(1)
+	address = id(p)
+	del p
+
+	# the memory isn't returned to the allocator, which would hand it to the next
+	# object of the same size...
+	other = bytes(module.PooledAllocCheck.__basicsize__ - sys.getsizeof(b''))
+	assert id(other) != address
+
+	# ...but is reused by the next wrapper
+	p = module.PooledAllocCheck(2)
+	assert id(p) == address and p.get() == 2
+	del p
+
+	class Sub(module.PooledAllocCheck):
+		pass
+
+	# subclass instances neither take wrappers from the freelist nor give theirs back
+	s = Sub(3)
+	assert id(s) != address and s.get() == 3
+	del s
+
+	p = module.PooledAllocCheck(4)
+	assert id(p) == address
+	del p, held
+
+
+def test_over_aligned():
+	objs = [module.OverAligned(i) for i in range(20)]
+	assert all(o.is_aligned() for o in objs)
+	assert objs[3].sum() == 48
+
+	with pytest.raises(TypeError):
+		class Sub(module.OverAligned):
+			pass
+
+
+def test_contiguous_buffer():
+	s = module.Samples(3)
+	view = memoryview(s)
+	assert view.format == 'd'
+	assert view.shape == (3,)
+	assert view.tolist() == [0.5, 1.5, 2.5]
+	view[0] = 10.0
+	assert s.total() == 14.0
+	assert not hasattr(s, 'data')
+
+	frozen = memoryview(module.FrozenSamples())
+	assert frozen.readonly
+	assert frozen.tolist() == [1, -2]
+	with pytest.raises(TypeError):
+		frozen[0] = 3
+
+	with pytest.raises(TypeError):
+		memoryview(module.OverAligned(1))
+
+def test_field_views():
+	s = module.Signal()
+	samples = s.samples
+	assert isinstance(samples, memoryview)
+	assert samples.tolist() == [1, 2, 3]
+	samples[0] = 4
+	s.gains[1] = 1
+	assert s.total() == 9
+
+	assert s.limits.readonly
+	assert s.limits.tolist() == [-1, 1]
+	with pytest.raises(AttributeError):
+		s.samples = [1]
+
+	# the view keeps the object alive
+	del s
+	assert samples.tolist() == [4, 2, 3]
+
+def test_strided_buffer():
+	m = module.PaddedMatrix()
+	view = memoryview(m)
+	assert view.shape == (2, 3)
+	assert view.strides == (16, 4)
+	assert view.tolist() == [[0, 1, 2], [10, 11, 12]]
+	view[1, 0] = 5
+	assert m.at(1, 0) == 5
+
+	interface = m.__array_interface__
+	assert interface['shape'] == (2, 3)
+	assert interface['strides'] == (16, 4)
+	assert interface['typestr'][1:] == 'f4'
+	assert interface['data'] == (interface['data'][0], False)
+	assert module.Samples(2).__array_interface__['shape'] == (2,)
+	assert not hasattr(module.OverAligned(1), '__array_interface__')
+
+
 def test_func_docstring():
 	assert module.docstring_test_1.__doc__.strip() == '()\ndocstring test 1'
 	assert module.docstring_test_2.__doc__.strip() == ('(i: int, j: std::string) -> int'
@@ -89,12 +206,110 @@ def test_overload():
 	assert module.overload('') == 'std::string'
 	# pyexport std::string overload(int, int) { return "int, int"; }
 	assert module.overload(1, 1) == 'int, int'
+	with pytest.raises(TypeError):
+		module.overload(1.5)
+	with pytest.raises(TypeError):
+		module.overload(1, 2, 3)
+
+def test_scalar_overload():
+	assert module.scalar_overload(1.5) == 'double'
+	assert module.scalar_overload(1) == 'double'
+	assert module.scalar_overload('') == 'std::string'
+	assert module.scalar_overload(1, False) == 'unsigned short, bool'
+	with pytest.raises(OverflowError):
+		module.scalar_overload(-1, False)
+	with pytest.raises(TypeError):
+		module.scalar_overload(1.0, False)
+
+def test_scalar_conversions():
+	assert module.half(3) == 1.5
+	assert module.successor(2**64 - 2) == 2**64 - 1
+	assert module.negated(False) is True
+	assert module.shorts([1, -2, 3]) == [1, -2, 3]
+	assert module.shorts((1, 2)) == [1, 2]
+	assert module.shorts(x for x in range(3)) == [0, 1, 2]
+	assert module.shorts(range(1000)) == list(range(1000))
+	with pytest.raises(OverflowError):
+		module.shorts([1, 2**15])
+	with pytest.raises(OverflowError):
+		module.successor(-1)
+
+def test_homogeneous_vectors():
+	class Float(float): pass
+	assert module.floats([0.5, 1.5]) == [0.5, 1.5]
+	assert module.floats([0.5, 1, Float(2)]) == [0.5, 1.0, 2.0]
+	assert module.floats([float('inf')]) == [float('inf')]
+	with pytest.raises(OverflowError):
+		module.floats([0.5, 1e300])
+	with pytest.raises(TypeError):
+		module.floats([0.5, 'x'])
+	with pytest.raises(OverflowError):
+		module.shorts(list(range(2**15 - 2, 2**15 + 2)))
+
+def test_buffer_arguments():
+	values = array.array('d', [0.5, 1.5])
+	assert module.span_total(values) == 2.0
+	assert module.span_total(memoryview(values)) == 2.0
+	# the buffer is released once the call returns
+	values.append(1.0)
+	with pytest.raises(TypeError):
+		module.span_total([0.5])
+	with pytest.raises(TypeError):
+		module.span_total(array.array('f', [0.5]))
+
+	ints = array.array('i', [1, -2])
+	module.span_negate(ints)
+	assert list(ints) == [-1, 2]
+	with pytest.raises(TypeError):
+		module.span_negate(memoryview(ints).toreadonly())
+
+	assert module.floats(array.array('f', [0.5, 2])) == [0.5, 2.0]
+	assert module.shorts(array.array('h', [3, -4])) == [3, -4]
+	assert module.shorts(memoryview(array.array('h', [1, 2, 3]))[::2]) == [1, 3]
+
+def test_borrowed_strings():
+	assert module.echo_ref('h\u00e9llo') == 'h\u00e9llo'
+	assert module.echo_ref(b'a\0b') == 'a\0b'
+	assert module.echo_ref(bytearray(b'xyz')) == 'xyz'
+	assert module.is_key('key')
+	assert module.is_key(b'key')
+	assert not module.is_key('keys')
+	with pytest.raises(TypeError):
+		module.is_key(1)
+
+def test_overload_repeated():
+	# alternatives are cached by argument types; alternate between them
+	for _ in range(3):
+		assert module.overload(1) == 'int'
+		assert module.overload('') == 'std::string'
+		assert module.overload(1, 1) == 'int, int'
+		assert module.ConstructorOverload(1).get() == 1
+		assert module.ConstructorOverload().get() == 0
+
+def test_named_overload():
+	assert module.named_overload(1) == 'a'
+	assert module.named_overload('') == 'b'
+	assert module.named_overload(a=1) == 'a'
+	assert module.named_overload(b='') == 'b'
+	with pytest.raises(TypeError):
+		module.named_overload(c=1)
 
 def test_constructor_overload():
 	assert module.ConstructorOverload().get() == 0
 	assert module.ConstructorOverload(1).get() == 1
 	assert module.ConstructorOverload(1,1).get() == 2
 
+def test_constructor_subclass():
+	class Sub(module.ConstructorOverload):
+		def __init__(self, *args):
+			self.args = args
+
+	s = Sub(1, 1)
+	assert s.get() == 2 and s.args == (1, 1)
+	assert type(module.ConstructorOverload(1)) is module.ConstructorOverload
+	with pytest.raises(TypeError):
+		module.ConstructorOverload(1, 2, 3)
+
 def test_field_getters():
 	acc = module.Accessors(1234)
 	assert acc.foo == 1234
@@ -110,6 +325,80 @@ def test_field_setter_validates_type():
 	with pytest.raises(TypeError):
 		acc.foo = 'abcd'
 
+def test_nothrow_accessors():
+	acc = module.NothrowAccessors()
+	assert acc.value == 0
+	acc.value = 42
+	assert acc.value == 42
+	with pytest.raises(TypeError):
+		acc.value = 'abcd'
+	with pytest.raises(OverflowError):
+		acc.value = 2**80
+
+def test_nothrow_function():
+	assert module.add_nothrow(1, 2) == 3
+	assert module.add_nothrow(b=1, a=2) == 3
+	with pytest.raises(TypeError):
+		module.add_nothrow(1, 'x')
+
+def test_returned_objects():
+	accs = module.make_accessors(3)
+	assert [a.foo for a in accs] == [0, 1, 2]
+
+def test_return_policies():
+	h = module.Holder()
+	h.copy().foo = 1
+	assert h.value() == 7
+
+	inner = h.get()
+	inner.foo = 2
+	assert h.value() == 2
+
+	del h
+	gc.collect()
+	assert inner.foo == 2
+
+def test_identity():
+	a = module.Node()
+	b = module.Node()
+	a.link(b)
+	b.link(b)
+	assert a.next() is b
+	assert b.next().next() is b
+
+def test_holders():
+	s = module.Shared()
+	module.keep_shared(s)
+	s.value = 3
+	del s
+	gc.collect()
+	assert module.kept_shared().value == 3
+
+	module.keep_shared(None)
+	assert module.kept_shared() is None
+
+	# wrappers from adopt() and from Python share the freelist
+	for i in range(100):
+		held = [module.make_pooled_shared(n) for n in range(8)]
+		created = [module.PooledShared() for n in range(8)]
+		assert [p.value for p in held] == list(range(8))
+		assert all(p.value == 0 for p in created)
+		del held, created
+
+	r = module.open_resource(4)
+	assert module.resource_id(r) == 4
+	assert module.resource_id(module.Resource(5)) == 5
+
+	# objects of abstract classes can only come from C++
+	square = module.make_square(3)
+	assert square.area() == 9
+	assert module.shape_area(square) == 9
+	with pytest.raises(TypeError):
+		module.Shape()
+
+	# Python could modify the object of a shared_ptr<const T>, so it is copied
+	assert module.const_shared(2).value == 2
+
 def test_field_docstring():
 	assert module.Accessors.foo.__doc__.strip() == 'docstring for foo'
 
@@ -118,6 +407,22 @@ def test_methods():
 	assert m.foo() == 'foobaz'
 	assert m.bar() == 'barbaz'
 
+def test_object_refs():
+	items = [1, 2, 3]
+	refs = sys.getrefcount(items)
+	assert module.iterated_sum(items) == 6
+	assert module.iterated_sum(iter(items)) == 6
+	assert sys.getrefcount(items) == refs
+
+def test_calls():
+	assert module.call_with(lambda a, b: (a, b), 1, 2) == (1, 2)
+	with pytest.raises(TypeError):
+		module.call_with(lambda a, c: 0, 1, 2)
+
+	assert module.call_method([3, 1, 3], 'count', 3) == 2
+	with pytest.raises(AttributeError):
+		module.call_method([], 'nope', 0)
+
 def test_exception_message():
 	def callback():
 		raise RuntimeError('foo')